@@ -36,4 +36,10 @@ class Blinker {
       }
       return _state;
     }
+
+    // msec till the next blink() changes the state, 0 if now
+    unsigned long next_deadline() {
+      unsigned long elapsed = millis() - timer;
+      return elapsed > (unsigned long) rate ? 0 : rate - elapsed + 1;
+    }
 };
@@ -2,6 +2,9 @@
 
 #include "ExponentialSmooth.h"
 #include "CrossOverDetect.h"
+#ifdef TELEMETRY_TX
+#include "Telemetry.h"
+#endif
 
 class CapTouchCrossover {
   /* 
@@ -21,6 +24,7 @@ class CapTouchCrossover {
     the exponential-smooth parameter (analogous to sample-window),
     a delta that has to be exceeded to count as cross-over (effectively debounces)
   For different environments, you have to adjust those. E.g. on a table, on a second table.
+  Or let CapTouchCalibration (below) work them out.
 
   Usage:
     
@@ -40,10 +44,9 @@ class CapTouchCrossover {
 
       // test on plotter (comment out when not testing):
       touch1.debug_print();
+      // or, faster, with TELEMETRY_TX (see Telemetry.h): touch1.telemetry(); Telemetry::run();
       }
 
-  
-  Todo: a training mode that tries to derive the parameters (at least delta).
   */
 
   private:
@@ -51,7 +54,7 @@ class CapTouchCrossover {
   public:
   // leave attributes public
   int pin;
-  CrossOverDetect<ExponentialSmooth> &crossover; // .v1.value
+  CrossOverDetect< ExponentialSmooth<int> > &crossover; // .v1.value
 
   // Intended for the analogRead(), so works in the int domain
   CapTouchCrossover(
@@ -61,7 +64,7 @@ class CapTouchCrossover {
     int delta
     ) : pin(analog_pin),
       // start assumes non-touching
-      crossover( *(new CrossOverDetect<ExponentialSmooth>(delta, new ExponentialSmooth(slow), new ExponentialSmooth(fast), -1)) )
+      crossover( *(new CrossOverDetect< ExponentialSmooth<int> >(delta, new ExponentialSmooth<int>(slow), new ExponentialSmooth<int>(fast), -1)) )
     {}
 
   void setup() {
@@ -105,4 +108,283 @@ class CapTouchCrossover {
     Serial.print( crossover.v1.value() - crossover.v2.value() );Serial.print(" "); // the measured delta
   }
 
+#ifdef TELEMETRY_TX
+  boolean telemetry() {
+    // a TelemetryCapTouch record: no println, no -50's. Do Telemetry::run() in loop()
+    return Telemetry::record(TelemetryCapTouch, pin, touching() - not_touching(),
+      crossover.v1.value(), crossover.v2.value(), crossover.v1.value() - crossover.v2.value()
+      );
+  }
+#endif
+
 };
+
+struct CapTouchAdc {
+  // Start an analog conversion, and check for it, without waiting (unlike analogRead()).
+  // Uses the DEFAULT analogReference.
+  // Not AVR: falls back to analogRead() in start().
+#if defined(__AVR__) && defined(ADCSRA) && defined(ADSC)
+  static void start(byte pin) {
+    if (pin >= A0) pin -= A0;
+    #ifdef analogPinToChannel
+      pin = analogPinToChannel(pin);
+    #endif
+    #ifdef MUX5
+      ADCSRB = (ADCSRB & ~(1 << MUX5)) | (((pin >> 3) & 0x01) << MUX5);
+    #endif
+    ADMUX = (DEFAULT << 6) | (pin & 0x07);
+    ADCSRA |= (1 << ADSC);
+    }
+  static boolean busy() { return ADCSRA & (1 << ADSC); }
+  static int result() {
+    byte low = ADCL; // must read ADCL first
+    byte high = ADCH;
+    return (high << 8) | low;
+    }
+#else
+  static int &_value() { static int v; return v; }
+  static void start(byte pin) { _value() = analogRead(pin); }
+  static boolean busy() { return false; }
+  static int result() { return _value(); }
+#endif
+  };
+
+template <byte N, typename Adc = CapTouchAdc>
+class CapTouchBank {
+  /*
+  N CapTouchCrossover's, without the heap, and without waiting on the ADC.
+  All the smoothing is in flat arrays.
+
+  Each run() checks if the ADC has finished, starts the next conversion,
+  then does the math on the result while that converts.
+  Each sensor is a read of its pin, then of the ref_pin (like CapTouchCrossover, A5), -1 for no ref_pin.
+
+    const byte pads[] = { A0, A1, A2, A3 };
+    CapTouchBank<4> touch(pads, 20, 50, 10); // fast, slow, delta like CapTouchCrossover
+    void setup() { touch.setup(); }
+    void loop() {
+      touch.run(); // often. true when it has done all N
+      if (touch.touched(2)) ...
+      }
+
+  Adc is anything with static start(pin), busy(), result(). E.g. a simulation.
+  */
+
+  public:
+  // leave attributes public
+  byte pins[N];
+  int ref_pin;
+  int delta;
+  ExponentialSmoothChannels<int, N> fast, slow;
+  int raw[N]; // last pin - ref_pin
+  int8_t state[N]; // -1 released, 1 touched, like CrossOverDetect
+  boolean changed[N];
+
+  byte current; // sensor being converted
+  boolean on_ref; // converting ref_pin for it
+  int pin_value; // for current, while we read the ref_pin
+
+  CapTouchBank(const byte (&pins)[N], int fast, int slow, int delta, int ref_pin = A5)
+    : ref_pin(ref_pin), delta(delta), fast(fast), slow(slow), current(0), on_ref(false)
+    {
+    for (byte i = 0; i < N; i++) {
+      this->pins[i] = pins[i];
+      raw[i] = 0;
+      state[i] = -1; // start assumes non-touching
+      changed[i] = false;
+      }
+    }
+
+  void setup() {
+    // at void setup(): so we start at a current read. blocks.
+    for (byte i = 0; i < N; i++) {
+      int v = blocking_read(pins[i]) - (ref_pin >= 0 ? blocking_read(ref_pin) : 0);
+      raw[i] = v;
+      fast.reset(i, v);
+      slow.reset(i, v);
+      }
+    current = 0;
+    on_ref = false;
+    Adc::start(pins[0]);
+    }
+
+  boolean run() {
+    // true when we've finished a round of all N
+    if (Adc::busy()) return false;
+    int v = Adc::result();
+
+    // start the next one before doing the math
+    byte i = current;
+    if (!on_ref && ref_pin >= 0) {
+      pin_value = v;
+      on_ref = true;
+      Adc::start(ref_pin);
+      return false;
+      }
+    if (on_ref) v = pin_value - v;
+    on_ref = false;
+    current = i + 1 == N ? 0 : i + 1;
+    Adc::start(pins[current]);
+
+    update(i, v);
+    return current == 0;
+    }
+
+  void update(byte i, int v) {
+    // a new reading for sensor i
+    raw[i] = v;
+    int s = slow.average(i, v);
+    int f = fast.average(i, v);
+    // same as CrossOverDetect(delta, slow, fast)
+    if ( state[i] != -1 && f - s >= delta ) { state[i] = -1; changed[i] = true; }
+    else if ( state[i] != 1 && s - f >= delta ) { state[i] = 1; changed[i] = true; }
+    }
+
+  boolean touched(byte i) {
+    // true only once, till released and touched again
+    if (state[i] != 1 || !changed[i]) return false;
+    changed[i] = false;
+    return true;
+    }
+
+  boolean released(byte i) {
+    // true only once, till touched and released again
+    if (state[i] != -1 || !changed[i]) return false;
+    changed[i] = false;
+    return true;
+    }
+
+  boolean touching(byte i) { return state[i] == 1; }
+  boolean not_touching(byte i) { return state[i] == -1; }
+
+  void debug_print(byte i) {
+    // like CapTouchCrossover::debug_print()
+    // NB: you supply trailing Serial.println() !
+    Serial.print( touching(i) * 10 + not_touching(i) * -10 + 1);Serial.print(" ");
+    Serial.print( slow.value(i) - 50 );Serial.print(" ");
+    Serial.print( fast.value(i) - 50 );Serial.print(" ");
+    Serial.print( slow.value(i) - fast.value(i) );Serial.print(" ");
+    }
+
+#ifdef TELEMETRY_TX
+  boolean telemetry(byte i) {
+    // a TelemetryCapTouch record for pad i (the pad index, not the pin)
+    return Telemetry::record(TelemetryCapTouch, i, state[i], slow.value(i), fast.value(i), slow.value(i) - fast.value(i));
+    }
+#endif
+
+  private:
+  static int blocking_read(byte pin) {
+    Adc::start(pin);
+    while (Adc::busy()) {}
+    return Adc::result();
+    }
+  };
+
+class CapTouchCalibration {
+  /*
+  Works out fast, slow, and delta from the readings, and keeps adapting.
+  Touch the pad a few times during each window (or at least the first one).
+
+    CapTouchCrossover touch1(A0, 20, 50, 10); // whatever guess
+    CapTouchCalibration calibrate(2000); // samples per window
+    void loop() {
+      if ( calibrate.sample( touch1.read() ) ) { // end of a window
+        calibrate.apply(touch1); // or just look at .fast .slow .delta, e.g. calibrate.debug_print()
+        }
+      ...
+
+  Per sample it's a couple of integer smoothers and a min/max.
+  At the end of each window:
+    noise: the average |reading - lightly-smoothed reading|
+    amplitude: the range of the lightly-smoothed reading, less its wander, i.e. touch vs not (if it's more than 3 * noise)
+    delta: amplitude/4 (not less than noise). If we didn't see a touch, delta stays.
+    fast: enough smoothing that the noise left is about delta/4 (at least 4). So more noise, more smoothing.
+    slow: 2.5 * fast (the slow-fast difference peaks about 1/3 of the amplitude, so delta is reachable)
+  For a CapTouchBank, all the pads share the values, so calibrate on the noisiest pad:
+    if ( bank.run() && calibrate.sample( bank.raw[2] ) ) calibrate.apply(bank);
+  */
+
+  public:
+  unsigned int window; // samples
+  unsigned int count;
+  boolean started;
+  ExponentialSmoothShift<int, 2> quick; // the reading, a little smoothed
+  ExponentialSmoothShift<long, 4> deviation; // |reading - quick| * 16
+  int lo, hi; // of quick, this window
+
+  // results, after the first window
+  int noise; // average deviation
+  int amplitude;
+  boolean saw_touch;
+  int fast, slow, delta;
+
+  CapTouchCalibration(unsigned int window = 2000) : window(window), count(0), started(false),
+    noise(0), amplitude(0), saw_touch(false), fast(0), slow(0), delta(0)
+    {}
+
+  boolean sample(int v) {
+    // true at the end of a window, with new fast, slow, delta
+    if (!started) {
+      quick.reset(v);
+      deviation.reset(0);
+      lo = hi = v;
+      started = true;
+      }
+    long d = v - quick.value(); // vs. before this sample, so it's nearer the real noise
+    deviation.average( (d < 0 ? -d : d) * 16 );
+    int q = quick.average(v);
+    if (q < lo) lo = q;
+    if (q > hi) hi = q;
+
+    if (++count < window) return false;
+    count = 0;
+    propose();
+    lo = hi = q;
+    return true;
+    }
+
+  void propose() {
+    noise = (deviation.value() + 15) / 16;
+    if (noise < 1) noise = 1;
+    amplitude = hi - lo - 3 * noise; // quick still wanders about 1.5 * noise either way
+    if (amplitude < 0) amplitude = 0;
+    saw_touch = amplitude >= 3 * noise;
+
+    if (saw_touch) delta = amplitude / 4;
+    else if (!delta) delta = 3 * noise; // nothing to go on yet
+    if (delta < noise) delta = noise;
+
+    // Smoothing by f leaves about noise * 1.25 / sqrt(2f - 1) (1.25: average deviation to std-dev).
+    // want that <= delta / 4, so 2f - 1 >= (5 * noise / delta)^2
+    long ratio = (5L * noise * 5L * noise + (long) delta * delta - 1) / ((long) delta * delta);
+    fast = (ratio + 2) / 2;
+    if (fast < 4) fast = 4;
+    slow = fast * 5 / 2;
+    }
+
+  void apply(CapTouchCrossover &touch) {
+    if (!fast) return; // no window yet
+    touch.crossover.delta = delta;
+    touch.crossover.v1.set_factor(slow);
+    touch.crossover.v2.set_factor(fast);
+    }
+
+  template <byte N, typename Adc>
+  void apply(CapTouchBank<N, Adc> &bank) {
+    if (!fast) return;
+    bank.delta = delta;
+    bank.slow.set_factor(slow);
+    bank.fast.set_factor(fast);
+    }
+
+  void debug_print() {
+    // NB: you supply trailing Serial.println() !
+    Serial.print(F("noise "));Serial.print(noise);
+    Serial.print(F(" amplitude "));Serial.print(amplitude);
+    Serial.print(saw_touch ? F(" touched") : F(" no touch"));
+    Serial.print(F(" fast "));Serial.print(fast);
+    Serial.print(F(" slow "));Serial.print(slow);
+    Serial.print(F(" delta "));Serial.print(delta);
+    }
+  };
@@ -35,6 +35,21 @@ class CrossOverDetect {
     return state() == 1;
     }
 
+  boolean off() {
+    // convenience if state == -1, i.e. if v2 > v1
+    return state() == -1;
+    }
+
+  boolean d_on() {
+    // changed to on, true only once
+    return state() == 1 && changed();
+    }
+
+  boolean d_off() {
+    // changed to off, true only once
+    return state() == -1 && changed();
+    }
+
   boolean changed() {
     boolean temp = _changed;
     _changed = 0; // always reset on query
@@ -1,17 +1,19 @@
 #pragma once
+#include <stddef.h>
+#include <stdint.h>
 
 template <typename ValueT> // for <int> or <float>
 class ExponentialSmooth {
   // a simple formula to sort-of do averaging: exponential smoothing
 
   float _smoothed; // need float for converging, i.e. no rounding loss funniness. use "(int) $thisobject", to get value.
+  float _factor; // forces operations to float space, actually a whole number
+  float alpha; // 1/factor, so we multiply instead of divide. average() only uses this
 
   public:
-  const float factor; // forces operations to float space, actually a whole number
-
   // "factor" is kind of like the the number of samples that are averaged.
   // So, "5" is sort of like taking 5 samples and averaging them.
-  ExponentialSmooth(const ValueT factor = 1) : factor(factor) {};
+  ExponentialSmooth(const ValueT factor = 1) : _factor(factor), alpha(1.0 / factor) {};
 
   ValueT smoothed() { return (ValueT) _smoothed; }
   ValueT value() { return (ValueT) _smoothed; }
@@ -19,10 +21,13 @@ class ExponentialSmooth {
   operator float() const { return (float) _smoothed; }
 
   ValueT reset(ValueT v) { _smoothed = v; return v;}
+  float factor() const { return _factor; }
+  void set_factor(float f) { _factor = f; alpha = 1.0 / f; } // the only way to change it, so alpha keeps up
 
   // we intend it to inline
   ValueT average(const ValueT raw_value) { 
-    _smoothed = raw_value / factor + _smoothed - _smoothed / factor; 
+    // same as raw_value / factor + _smoothed - _smoothed / factor
+    _smoothed += (raw_value - _smoothed) * alpha; 
     /*
     Serial.print("X"); Serial.print((int) this); Serial.print("/");
     Serial.print(factor); Serial.print(" ");
@@ -34,4 +39,81 @@ class ExponentialSmooth {
     return (ValueT) _smoothed;
     }
 
+  // A block of samples (e.g. from DMA), out can be the same as in. Returns the last.
+  ValueT average_block(const ValueT *in, ValueT *out, size_t n) {
+    float s = _smoothed; // keep it in a register
+    for (size_t i = 0; i < n; i++) {
+      s += (in[i] - s) * alpha;
+      out[i] = (ValueT) s;
+      }
+    _smoothed = s;
+    return (ValueT) s;
+    }
+
+  };
+
+template <typename ValueT, size_t Channels>
+class ExponentialSmoothChannels {
+  // Many independent channels, same factor. Struct-of-arrays so the per-channel loop can vectorize.
+  //   ExponentialSmoothChannels<int, 8> adcs(5);
+  //   adcs.average(eight_readings, eight_smoothed); // one sample per channel
+  //   adcs.average_block(frames, smoothed_frames, n); // n frames of [Channels] samples, interleaved
+
+  float _smoothed[Channels];
+  float _factor;
+  float alpha; // 1/factor
+
+  public:
+  ExponentialSmoothChannels(const ValueT factor = 1) : _smoothed(), _factor(factor), alpha(1.0 / factor) {};
+
+  ValueT value(size_t channel) { return (ValueT) _smoothed[channel]; }
+  void reset(ValueT v) { for (size_t c = 0; c < Channels; c++) _smoothed[c] = v; }
+  float factor() const { return _factor; }
+  void set_factor(float f) { _factor = f; alpha = 1.0 / f; } // like ExponentialSmooth
+
+  // one sample for one channel
+  ValueT average(size_t channel, const ValueT raw_value) {
+    _smoothed[channel] += (raw_value - _smoothed[channel]) * alpha;
+    return (ValueT) _smoothed[channel];
+    }
+  void reset(size_t channel, ValueT v) { _smoothed[channel] = v; }
+
+  // in & out are [Channels]
+  void average(const ValueT *in, ValueT *out) {
+    for (size_t c = 0; c < Channels; c++) {
+      _smoothed[c] += (in[c] - _smoothed[c]) * alpha;
+      out[c] = (ValueT) _smoothed[c];
+      }
+    }
+
+  // in & out are [frames][Channels]
+  void average_block(const ValueT *in, ValueT *out, size_t frames) {
+    for (size_t f = 0; f < frames; f++, in += Channels, out += Channels) average(in, out);
+    }
+  };
+
+template <typename ValueT, uint8_t Shift, typename AccT = long>
+class ExponentialSmoothShift {
+  // Same smoothing, factor is 2^Shift, integer only (no float, no division).
+  // The accumulator keeps Shift extra bits, so it converges exactly to a steady input (no rounding loss).
+  //   ExponentialSmoothShift<int, 3> smooth; // like ExponentialSmooth<int>(8)
+  // AccT has to hold ValueT << Shift: a 10 bit analogRead << 5 fits in an AVR int, << 6 needs a long (the default).
+
+  AccT _acc; // smoothed << Shift
+
+  public:
+  static const int factor = 1 << Shift;
+
+  ExponentialSmoothShift() : _acc(0) {}
+
+  ValueT smoothed() const { return (ValueT) (_acc >> Shift); }
+  ValueT value() const { return smoothed(); }
+  operator int() const { return (int) smoothed(); }
+
+  ValueT reset(ValueT v) { _acc = (AccT) v * factor; return v; }
+
+  ValueT average(const ValueT raw_value) {
+    _acc += (AccT) raw_value - (_acc >> Shift);
+    return smoothed();
+    }
   };
@@ -0,0 +1,165 @@
+#pragma once
+
+/*
+  Binary telemetry, instead of Serial.print'ing lines for the Serial Plotter.
+
+  Printing floats as text is slow (about 35 bytes a line for auto_bilevel_graph),
+  and Serial.print blocks when the serial buffer is full, which changes the timing you are trying to tune.
+  Instead, each sample is a small binary record put in a ring, and run() feeds the ring to Serial
+  only as fast as Serial can take it, never blocking. If the ring is full, the record is dropped (and counted).
+
+    #define TELEMETRY_TX 128 // ring size in bytes, a power of 2. Before the #includes
+    #include "Telemetry.h"
+    ...
+    void loop() {
+      Telemetry::run(); // every loop, moves bytes to Serial
+      Telemetry::record(TelemetryUser, a, b, c); // up to 32 values, sent as int16's. Or up to 16, as int32's if one needs it
+      ...
+
+  With TELEMETRY_TX defined, these also have telemetry (see each):
+    auto_bilevel_graph() (sends instead of printing), AutoBilevel::telemetry(),
+    CapTouchCrossover::telemetry(), CapTouchBank::telemetry(i), PWM_NeoPixel::print() (sends instead of printing)
+  Don't mix in other Serial.print's, they would corrupt records (the decoder skips those).
+
+  A record, before framing: id, seq, values (int16, little-endian), checksum (8 bit sum of the rest).
+    If a value doesn't fit in an int16 (e.g. a CapacitiveSensor reading), that record is all int32's,
+    and has TelemetryWide set in the id. So, ids are 0..127. Past an int32 (or a float that is), values are clipped.
+    seq counts every record (even dropped ones), so gaps show drops.
+  Framing is COBS (no 0 bytes in a frame), and a 0 after each frame, so a reader can always find the next one.
+  So 5 values is 15 bytes on the wire.
+
+  telemetry-decode (next to this file) turns the stream back into CSV:
+    stty -F /dev/ttyACM0 115200 raw; ./telemetry-decode < /dev/ttyACM0 > samples.csv
+*/
+
+#ifndef TELEMETRY_TX
+  #define TELEMETRY_TX 128 // at least 2 * MaxValues + 5
+#endif
+
+enum {
+  // record ids
+  TelemetryAutoBilevel = 1, // raw, fast, slow, significant, state (telemetry-decode adds fast - significant, slow + state)
+  TelemetryCapTouch = 2, // pin (or pad), state (1 touching, -1 not, 0 don't know), slow, fast, slow - fast
+  TelemetryNeoPixel = 3, // r,g,b per pixel
+  TelemetryUser = 16, // yours from here
+  TelemetryWide = 0x80 // flag in the id byte: int32 values
+  };
+
+class Telemetry {
+  public:
+  static_assert( (TELEMETRY_TX & (TELEMETRY_TX - 1)) == 0, "TELEMETRY_TX must be a power of 2");
+  static const byte MaxValues = 32; // int16's, half as many int32's
+
+  struct State {
+    byte ring[TELEMETRY_TX];
+    unsigned int head, tail; // head == tail is empty
+    byte seq;
+    unsigned int dropped;
+    // COBS, while encoding
+    unsigned int code_at;
+    byte code;
+    };
+  static State &state() { static State s; return s; }
+
+  static unsigned int room() {
+    State &s = state();
+    return (s.tail - s.head - 1) & (TELEMETRY_TX - 1);
+    }
+
+  // false if it was dropped
+  static boolean record_array(byte id, const int16_t *values, byte n) { return _record(id, values, n); }
+  static boolean record_array(byte id, const int32_t *values, byte n) { return _record(id | TelemetryWide, values, n); }
+
+  template <typename... Ts>
+  static boolean record(byte id, Ts... values) {
+    // int16's if they all fit, else int32's
+    const byte n = sizeof...(values);
+    const int32_t v[] = { _clip<int32_t>(values)... };
+    int16_t narrow[n];
+    for (byte i = 0; i < n; i++) {
+      narrow[i] = (int16_t) v[i];
+      if (narrow[i] != v[i]) return record_array(id, v, n);
+      }
+    return record_array(id, narrow, n);
+    }
+
+  template <typename S>
+  static void run(S &out) {
+    // as much as out will take without blocking
+    State &s = state();
+    int n = out.availableForWrite();
+    while (n-- > 0 && s.tail != s.head) {
+      out.write(s.ring[s.tail]);
+      s.tail = (s.tail + 1) & (TELEMETRY_TX - 1);
+      }
+    }
+  static void run() { run(Serial); }
+
+  private:
+  template <typename V>
+  static boolean _record(byte id, const V *values, byte n) {
+    State &s = state();
+    const byte seq = s.seq++;
+    if (n > MaxValues * 2 / sizeof(V)) n = MaxValues * 2 / sizeof(V);
+    // id, seq, values, checksum + the COBS code + the 0
+    if (room() < 2u + sizeof(V) * n + 1 + 1 + 1) { s.dropped++; return false; }
+
+    start_frame();
+    byte sum = id + seq;
+    put(id);
+    put(seq);
+    for (byte i = 0; i < n; i++) {
+      uint32_t v = (uint32_t) values[i]; // little-endian, whatever we are
+      for (byte b = 0; b < sizeof(V); b++, v >>= 8) {
+        sum += (byte) v;
+        put( (byte) v );
+        }
+      }
+    put(sum);
+    end_frame();
+    return true;
+    }
+
+  // Clip to what fits in V (int32_t), instead of wrapping. Floats too (NaN is 0).
+  template <typename V> static constexpr long _max() { return (long) ( (1UL << (8 * sizeof(V) - 1)) - 1 ); }
+  template <typename V> static V _clip(long v) { return v > _max<V>() ? _max<V>() : v < -_max<V>() - 1 ? -_max<V>() - 1 : (V) v; }
+  template <typename V> static V _clip(unsigned long v) { return v > (unsigned long) _max<V>() ? _max<V>() : (V) v; }
+  template <typename V> static V _clip(int v) { return _clip<V>( (long) v ); }
+  template <typename V> static V _clip(unsigned int v) { return _clip<V>( (unsigned long) v ); }
+  template <typename V> static V _clip(double v) {
+    return v >= _max<V>() ? _max<V>() : v <= -_max<V>() - 1 ? -_max<V>() - 1 : v == v ? (V) v : 0;
+    }
+
+  static void push(byte b) {
+    State &s = state();
+    s.ring[s.head] = b;
+    s.head = (s.head + 1) & (TELEMETRY_TX - 1);
+    }
+
+  // COBS: each 0 is replaced by the distance to the next 0 (the "code"), the first code goes in front
+  static void start_frame() {
+    State &s = state();
+    s.code_at = s.head;
+    s.code = 1;
+    push(0); // code, filled in later
+    }
+
+  static void put(byte b) {
+    State &s = state();
+    if (b == 0) {
+      s.ring[s.code_at] = s.code;
+      start_frame();
+      }
+    else {
+      push(b);
+      // can't happen with MaxValues, but a run of 254 would need a new code
+      if (++s.code == 0xFF) { s.ring[s.code_at] = s.code; start_frame(); }
+      }
+    }
+
+  static void end_frame() {
+    State &s = state();
+    s.ring[s.code_at] = s.code;
+    push(0);
+    }
+  };
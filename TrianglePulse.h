@@ -1,73 +1,59 @@
 #include <Arduino.h>
 
-#define debugm(msg) Serial.print(msg)
+// #define debugm(msg) Serial.print(msg)
+#define debugm(msg)
 
 struct TrianglePulse {
+  // The value is calculated from the time since we started, so it doesn't drift,
+  // and millis() rollover is fine. Integer math in next() (the slopes are Q16.16).
   TrianglePulse(
       byte t_min, byte t_max, // range of the pulse
       unsigned long wavelength_ms, // in msec
-      float rise_fraction = 0.5 // .25 means rise for 1/4 the wavelength time, fall for 3/4
-      ) : t_min(t_min), t_max(t_max)
+      float rise_fraction = 0.5 // .25 means rise for 1/4 the wavelength time, fall for 3/4. only used here
+      ) : t_min(t_min), t_max(t_max), value(t_min)
     {
-    value = t_min;
-    // calculate it
-    float rise_duration = rise_fraction * wavelength_ms;
-    calc_deltas(rise_duration, (t_max-t_min), &delta_rise, &delta_rise_delay);
-    calc_deltas(wavelength_ms - rise_duration, (t_max-t_min), &delta_fall, &delta_fall_delay);
-    delta_fall = -delta_fall;
-    delta = delta_rise;
-    next_step_at = millis() + delta_rise_delay;
-    delta_delay = delta_rise_delay;
+    this->wavelength_ms = wavelength_ms ? wavelength_ms : 1;
+    rise_ms = rise_fraction * this->wavelength_ms;
+    if (rise_ms > this->wavelength_ms) rise_ms = this->wavelength_ms;
+    rise_slope = slope(rise_ms);
+    fall_slope = slope(this->wavelength_ms - rise_ms);
+    start = millis();
     debugm("Tinit for length ");debugm(wavelength_ms);
-    debugm(" rise for ");debugm(rise_duration);
-    debugm(" rise by ");debugm(delta_rise);debugm(" every ");debugm(delta_rise_delay);
-    debugm(" fall by ");debugm(delta_fall);debugm(" every ");debugm(delta_fall_delay);
+    debugm(" rise for ");debugm(rise_ms);
     debugm("\n");
     }
 
-  void calc_deltas(unsigned long duration, byte range, float *delta, unsigned long *delta_delay) {
-    if (duration > range) {
-      // msec per delta
-      *delta = 1;
-      *delta_delay = duration / range; // rounding will lead to drift! 
-      }
-    else {
-      // delta per msec
-      *delta_delay = 1;
-      *delta = (float) range / duration; // rounding may jump at min/max
-      }
+  unsigned long slope(unsigned long duration) {
+    // Q16.16 range per msec
+    return duration ? ( (unsigned long)(t_max - t_min) << 16 ) / duration : 0;
     }
 
   byte t_min, t_max;
-  unsigned long delta_rise_delay, delta_fall_delay;
-  unsigned long delta_delay;
-  float delta_rise, delta_fall;
-  float delta;
+  unsigned long wavelength_ms;
+  unsigned long rise_ms;
+  unsigned long rise_slope, fall_slope; // Q16.16
+
+  byte value;
 
-  float value;
+  unsigned long start; // millis() at the beginning of this wave
 
-  unsigned long next_step_at; // FIXME: rollover of millis()
+  void restart() { start = millis(); value = t_min; }
+
+  byte at(unsigned long phase) {
+    // value at phase msec into the wave
+    if (phase < rise_ms) return t_min + ( (phase * rise_slope + 0x8000) >> 16 );
+    return t_max - ( ( (phase - rise_ms) * fall_slope + 0x8000 ) >> 16 );
+    }
 
   boolean next() { // returns false at end of pulse, but you can keep going for another cycle
-    if (millis() >= next_step_at) {
-      debugm("its time");debugm(millis());debugm("\n");
-      // FIXME: do drift prevention
-      value += delta;
-      if (delta < 0 && value <= t_min) {
-        value = t_min;
-        delta = delta_rise;
-        delta_delay = delta_rise_delay;
-        debugm("  v=");debugm(value);
-        }
-      else if (delta > 0 && value >= t_max) {
-        value = t_max;
-        delta = delta_fall;
-        delta_delay = delta_fall_delay;
-        debugm("  v=");debugm(value);
-        }
-      next_step_at = millis() + delta_delay;
-      debugm(" nxt ");debugm(next_step_at);debugm("\n");
+    unsigned long phase = millis() - start; // rollover safe
+    if (phase >= wavelength_ms) {
+      // move start up by whole waves, so no drift
+      unsigned long waves = phase - phase % wavelength_ms;
+      start += waves;
+      phase -= waves;
       }
+    value = at(phase);
     return value != t_min;
     }
   };
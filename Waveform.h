@@ -0,0 +1,202 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+  Waveforms from elapsed time, integer math, curves from lookup tables in PROGMEM.
+  Like TrianglePulse: call next() in loop(), use .value (a byte, e.g. for analogWrite).
+
+  Waveform breath(waveform_breathe, 4000); // repeats every 4 seconds, 0..255
+  Waveform wobble(waveform_sine, 1000, 50, 200); // between 50 and 200
+    breath.next(); analogWrite(led, breath.value); // next() is false when a wave finishes
+
+  Ramp motor(waveform_ease_in_out, 2000, 0, 255); // once, from 0 to 255 in 2 seconds
+    motor.next(); // false when done, .value stays at the "to"
+    motor.restart(); or motor.begin(from, to, duration_ms)
+
+  ADSR envelope(50, 200, 180, 1000); // attack ms, decay ms, sustain level, release ms
+    envelope.on(); ... envelope.off(); // e.g. on button down/up
+    envelope.next(); // false when it's finished releasing
+
+  Curves (65 bytes each): waveform_sine, waveform_breathe, waveform_ease_in, waveform_ease_out,
+    waveform_ease_in_out, waveform_exponential. NULL is linear. Or make your own: 65 values,
+    0..255, for 0/64 .. 64/64 of the way through. We interpolate between them.
+  The phase is computed with a precomputed reciprocal (no division per sample),
+    good for durations up to 2^24 ms (4.6 hours).
+*/
+
+const byte waveform_sine[] PROGMEM = { // one cycle, starting at the bottom: 0..255..0
+    0,   1,   2,   5,  10,  15,  21,  29,  37,  47,  57,  67,  79,  90, 103, 115,
+  127, 140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254,
+  255, 254, 253, 250, 245, 240, 234, 226, 218, 208, 198, 188, 176, 165, 152, 140,
+  128, 115, 103,  90,  79,  67,  57,  47,  37,  29,  21,  15,  10,   5,   2,   1,
+    0,
+  };
+const byte waveform_breathe[] PROGMEM = { // the sine, gamma corrected (2.2) for LEDs: looks like breathing
+    0,   0,   0,   0,   0,   1,   1,   2,   4,   6,   9,  14,  19,  26,  34,  44,
+   55,  68,  82,  97, 113, 130, 147, 164, 180, 196, 210, 223, 234, 243, 250, 254,
+  255, 254, 250, 243, 234, 223, 210, 196, 180, 164, 147, 130, 113,  97,  82,  68,
+   55,  44,  34,  26,  19,  14,   9,   6,   4,   2,   1,   1,   0,   0,   0,   0,
+    0,
+  };
+const byte waveform_ease_in[] PROGMEM = { // 0..255, slow start
+    0,   0,   0,   1,   1,   2,   2,   3,   4,   5,   6,   8,   9,  11,  12,  14,
+   16,  18,  20,  22,  25,  27,  30,  33,  36,  39,  42,  45,  49,  52,  56,  60,
+   64,  68,  72,  76,  81,  85,  90,  95, 100, 105, 110, 115, 121, 126, 132, 138,
+  143, 149, 156, 162, 168, 175, 182, 188, 195, 202, 209, 217, 224, 232, 239, 247,
+  255,
+  };
+const byte waveform_ease_out[] PROGMEM = { // 0..255, slow end
+    0,   8,  16,  23,  31,  38,  46,  53,  60,  67,  73,  80,  87,  93,  99, 106,
+  112, 117, 123, 129, 134, 140, 145, 150, 155, 160, 165, 170, 174, 179, 183, 187,
+  191, 195, 199, 203, 206, 210, 213, 216, 219, 222, 225, 228, 230, 233, 235, 237,
+  239, 241, 243, 244, 246, 247, 249, 250, 251, 252, 253, 253, 254, 254, 255, 255,
+  255,
+  };
+const byte waveform_ease_in_out[] PROGMEM = { // 0..255, slow start & end
+    0,   0,   1,   1,   2,   4,   5,   7,  10,  12,  15,  18,  21,  25,  29,  33,
+   37,  42,  47,  52,  57,  62,  67,  73,  79,  85,  90,  97, 103, 109, 115, 121,
+  127, 134, 140, 146, 152, 158, 165, 170, 176, 182, 188, 193, 198, 203, 208, 213,
+  218, 222, 226, 230, 234, 237, 240, 243, 245, 248, 250, 251, 253, 254, 254, 255,
+  255,
+  };
+const byte waveform_exponential[] PROGMEM = { // 0..255, 2^(8t)-1: looks linear for LED brightness
+    0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   3,
+    3,   3,   4,   4,   5,   5,   6,   6,   7,   8,   9,   9,  10,  11,  12,  14,
+   15,  16,  18,  20,  22,  24,  26,  28,  31,  34,  37,  40,  44,  48,  53,  58,
+   63,  69,  75,  82,  90,  98, 107, 116, 127, 139, 151, 165, 180, 196, 214, 234,
+  255,
+  };
+
+inline byte waveform_at(const byte *curve, uint16_t phase) {
+  // 0..255 from the curve, phase 0..65535 is 0..1
+  if (!curve) return phase >> 8; // linear
+  byte i = phase >> 10;
+  byte frac = phase >> 2;
+  int a = pgm_read_byte(curve + i);
+  int b = pgm_read_byte(curve + i + 1);
+  return a + ( ( (b - a) * frac ) >> 8 );
+  }
+
+inline byte waveform_scale(byte x, byte lo, byte hi) {
+  // 0..255 to lo..hi (hi can be less)
+  if (hi >= lo) return lo + ( ( (unsigned int) x * (hi - lo + 1) ) >> 8 );
+  return lo - ( ( (unsigned int) x * (lo - hi + 1) ) >> 8 );
+  }
+
+inline unsigned long waveform_inverse(unsigned long duration_ms) {
+  // so the phase is (ms * inverse) >> 8
+  return (1UL << 24) / (duration_ms ? duration_ms : 1);
+  }
+
+struct Waveform {
+  // curve, repeating
+  Waveform(const byte *curve, unsigned long wavelength_ms, byte lo = 0, byte hi = 255)
+    : curve(curve), lo(lo), hi(hi), value(lo)
+    {
+    this->wavelength_ms = wavelength_ms ? wavelength_ms : 1;
+    inverse = waveform_inverse(this->wavelength_ms);
+    start = millis();
+    }
+
+  const byte *curve;
+  byte lo, hi;
+  unsigned long wavelength_ms;
+  unsigned long inverse;
+
+  byte value;
+
+  unsigned long start; // millis() at the beginning of this wave
+
+  void restart() { start = millis(); value = lo; }
+
+  boolean next() { // returns false at end of a wave, but keeps going
+    unsigned long ms = millis() - start; // rollover safe
+    boolean more = true;
+    if (ms >= wavelength_ms) {
+      // move start up by whole waves, so no drift
+      unsigned long waves = ms - ms % wavelength_ms;
+      start += waves;
+      ms -= waves;
+      more = false;
+      }
+    value = waveform_scale( waveform_at(curve, (ms * inverse) >> 8), lo, hi );
+    return more;
+    }
+  };
+
+struct Ramp {
+  // curve, once, from..to
+  Ramp(const byte *curve, unsigned long duration_ms, byte from, byte to) : curve(curve) {
+    begin(from, to, duration_ms);
+    }
+
+  const byte *curve;
+  byte from, to;
+  unsigned long duration_ms;
+  unsigned long inverse;
+  boolean done;
+
+  byte value;
+
+  unsigned long start;
+
+  void begin(byte from, byte to, unsigned long duration_ms) { begin(from, to, duration_ms, millis()); }
+  void begin(byte from, byte to, unsigned long duration_ms, unsigned long at) {
+    this->from = from;
+    this->to = to;
+    this->duration_ms = duration_ms;
+    inverse = waveform_inverse(duration_ms);
+    start = at;
+    value = from;
+    done = false;
+    }
+  void restart() { begin(from, to, duration_ms); }
+  // another ramp from where this one ends, starting when it ended (so no drift)
+  void then(byte to, unsigned long duration_ms) { begin(this->to, to, duration_ms, start + this->duration_ms); }
+
+  boolean next() { // returns false when done
+    if (done) return false;
+    unsigned long ms = millis() - start;
+    if (ms >= duration_ms) {
+      value = to;
+      done = true;
+      return false;
+      }
+    value = waveform_scale( waveform_at(curve, (ms * inverse) >> 8), from, to );
+    return true;
+    }
+  };
+
+struct ADSR {
+  // attack to peak, decay to sustain, hold at sustain till off(), release to 0
+  ADSR(unsigned long attack_ms, unsigned long decay_ms, byte sustain, unsigned long release_ms, byte peak = 255, const byte *curve = NULL)
+    : attack_ms(attack_ms), decay_ms(decay_ms), release_ms(release_ms), sustain(sustain), peak(peak), stage(Idle), ramp(curve, 0, 0, 0), value(0)
+    {
+    ramp.done = true;
+    }
+
+  enum Stage { Idle, Attack, Decay, Sustain, Release };
+
+  unsigned long attack_ms, decay_ms, release_ms;
+  byte sustain, peak;
+  Stage stage;
+  Ramp ramp;
+
+  byte value;
+
+  void on() { stage = Attack; ramp.begin(ramp.value, peak, attack_ms); } // from wherever we are
+  void off() { if (stage != Idle) { stage = Release; ramp.begin(ramp.value, 0, release_ms); } }
+
+  boolean next() { // returns false when idle (released)
+    while ( (stage == Attack || stage == Decay || stage == Release) && ! ramp.next() ) {
+      // this ramp finished, next stage starts when it ended
+      switch (stage) {
+        case Attack: stage = Decay; ramp.then(sustain, decay_ms); break;
+        case Decay: stage = Sustain; break;
+        default: stage = Idle; break;
+        }
+      }
+    value = ramp.value;
+    return stage != Idle;
+    }
+  };
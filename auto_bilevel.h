@@ -2,7 +2,7 @@
   fixme: plain auot isn't float
   fixme: exponentional isn't float
   fixme: we don't take floats
-  fixme: template
+  (AutoBilevel, at the end, is the template, integer-exact, and works for more than 1 sensor)
 
   If an "analog" sensor is a bit noisy,
   and has a floor, and an "on" level, 
@@ -103,9 +103,39 @@ For this to work, we have to read raw-values pretty often (because we average th
       # same as auto_bilevel(), but does serial.println with values for Serial Plotter
 
     # auto_bilevel_graph() remembers some values from call-to-call, so only use it for one sensor.
+    # Ditto auto_bilevel() and exponential_smooth(). For more sensors, use AutoBilevel.
+
+    # With TELEMETRY_TX defined (see Telemetry.h), auto_bilevel_graph() sends a binary record instead of printing.
+
+  * Many Sensors, Object Interface
+  # Each AutoBilevel keeps its own state, so have as many as you like.
+  # The factors are powers of 2 (given as the shift), so the smoothing is all integer and exact:
+  #   AutoBilevel<int, 2, 5> touch(50); // fast 4, slow 32, significant 50
+
+  AutoBilevel<int, 2, 5> touch(50);
+  void loop() {
+    if ( touch.update( somesensor.read() ) ) { // true if it changed
+      if (touch.on()) { do something...; }
+      else { do something when "released"; }
+      }
+    // or just touch.on(), which stays on till the signal actually drops ("hysteresis")
+    // touch.debug_print(); Serial.println(); // like auto_bilevel_graph
+    }
+
+  # A bank of them, e.g. 16 sensors in one loop:
+  AutoBilevelBank<int, 2, 5, 16> sensors(50);
+  void loop() {
+    for (byte i = 0; i < 16; i++) sensors.update(i, analogRead(A0 + i));
+    if (sensors[3].on()) ...
+    }
 
 */
 
+#include "ExponentialSmooth.h"
+#ifdef TELEMETRY_TX
+#include "Telemetry.h"
+#endif
+
 // template (type T)
 boolean auto_bilevel(const long raw, const int fast_factor, const int slow_factor, const long significant) {
   static long fast_smooth = raw;
@@ -126,12 +156,16 @@ boolean auto_bilevel(const long raw, const int fast_factor, const int slow_facto
   // and vice-versa.
   // if the change itself is small, then of course the difference is small.
 
+  // in between, we stay the same
+  static boolean last = false;
+
   if ( (fast_smooth - slow_smooth) >= significant ) {
-    return true;
+    last = true;
   }
   else if ( (fast_smooth - slow_smooth) <= -significant ) {
-    return false;
+    last = false;
   }
+  return last;
 }
 
 
@@ -157,26 +191,102 @@ boolean auto_bilevel_graph(const long raw, const int fast_factor, const int slow
   fast_smooth = (raw / (fast_factor+0.0) + fast_smooth - fast_smooth / fast_factor);
   slow_smooth = (raw / (slow_factor+0.0) + slow_smooth - slow_smooth / slow_factor);
 
-  Serial.print(raw); Serial.print(" ");
-  Serial.print(fast_smooth); Serial.print(" ");
-  Serial.print(slow_smooth); Serial.print(" ");
-  Serial.print(fast_smooth - significant); Serial.print(" ");
-
   // the slow lags the fast during changes.
   // if the rate of change is relatively slow, then the lag (the difference) is small
   // and vice-versa.
   // if the change itself is small, then of course the difference is small.
 
   if ( (fast_smooth - slow_smooth) >= significant ) {
-    Serial.println(slow_smooth + 1);
     last = true;
   }
   else if ( (fast_smooth - slow_smooth) <= -significant ) {
-    Serial.println(slow_smooth);
     last = false;
   }
-  else {
-    Serial.println(slow_smooth + (last ? 1 : 0));
-    }
+
+#ifdef TELEMETRY_TX
+  Telemetry::record(TelemetryAutoBilevel, raw, fast_smooth, slow_smooth, significant, last); // telemetry-decode adds the plot's other 2 columns
+#else
+  Serial.print(raw); Serial.print(" ");
+  Serial.print(fast_smooth); Serial.print(" ");
+  Serial.print(slow_smooth); Serial.print(" ");
+  Serial.print(fast_smooth - significant); Serial.print(" ");
+  Serial.println(slow_smooth + (last ? 1 : 0)); // the doubling shows when "on"
+#endif
+
   return last;
 } 
+
+template <typename T, byte FastShift, byte SlowShift, typename AccT = long>
+class AutoBilevel {
+  // Same as auto_bilevel(), but its state is here, not in the function.
+  // Factors are 1 << FastShift, 1 << SlowShift.
+  // AccT has to hold T << SlowShift.
+
+  public:
+  T significant;
+  ExponentialSmoothShift<T, FastShift, AccT> fast;
+  ExponentialSmoothShift<T, SlowShift, AccT> slow;
+  boolean state; // on/off, in between the last one holds
+  boolean started;
+
+  AutoBilevel(const T significant = 1) : significant(significant), state(false), started(false) {}
+
+  void reset(const T raw) {
+    fast.reset(raw); slow.reset(raw);
+    started = true;
+    }
+
+  boolean update(const T raw) {
+    // true if it changed
+    if (!started) reset(raw);
+    fast.average(raw);
+    slow.average(raw);
+
+    const boolean was = state;
+    const T diff = fast.value() - slow.value();
+    if ( diff >= significant ) state = true;
+    else if ( diff <= -significant ) state = false;
+    return state != was;
+    }
+
+  boolean on() const { return state; }
+  operator boolean() const { return state; }
+
+  void debug_print() {
+    // same columns as auto_bilevel_graph(), less the raw: print that first yourself if you want it
+    // NB: you supply trailing Serial.println() !
+    Serial.print(fast.value()); Serial.print(" ");
+    Serial.print(slow.value()); Serial.print(" ");
+    Serial.print(fast.value() - significant); Serial.print(" ");
+    Serial.print(slow.value() + (state ? 1 : 0));
+    }
+
+#ifdef TELEMETRY_TX
+  boolean telemetry(const T raw) {
+    // a TelemetryAutoBilevel record, like auto_bilevel_graph()'s
+    return Telemetry::record(TelemetryAutoBilevel, raw, fast.value(), slow.value(), significant, state);
+    }
+#endif
+  };
+
+template <typename T, byte FastShift, byte SlowShift, byte N, typename AccT = long>
+class AutoBilevelBank {
+  // N AutoBilevel's with the same parameters. [i] is the i'th
+  public:
+  AutoBilevel<T, FastShift, SlowShift, AccT> channel[N];
+
+  AutoBilevelBank(const T significant = 1) {
+    for (byte i = 0; i < N; i++) channel[i].significant = significant;
+    }
+
+  AutoBilevel<T, FastShift, SlowShift, AccT> &operator[](byte i) { return channel[i]; }
+
+  boolean update(byte i, const T raw) { return channel[i].update(raw); }
+
+  byte update(const T (&raw)[N]) {
+    // all of them, returns how many changed
+    byte changed = 0;
+    for (byte i = 0; i < N; i++) changed += channel[i].update(raw[i]);
+    return changed;
+    }
+  };
@@ -0,0 +1 @@
+../../ExponentialSmooth.h
\ No newline at end of file
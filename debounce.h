@@ -64,6 +64,37 @@ This is like debouncing, or smoothing. It will delay responding to a change, how
       }
     }
 
+# Saving RAM: Compile-Time Durations
+
+Each Debounce above takes about 10 bytes. If the durations are constants, these take 2 bytes
+(a 14 bit millis() timestamp, plus 2 bits of state), and do the same thing:
+
+  DebounceOf<10> debounce_switch; // like Debounce(10)
+  DebounceAsymmetricOf<100, 10> debounce_sensor(HIGH); // like DebounceAsymmetric(HIGH, 100, 10)
+  DebounceHighOf<100> sleep; // like DebounceHigh(100). and DebounceLowOf<n>
+
+Durations have to be less than 16384 msec, and you have to call it at least that often (it's a rolling timestamp).
+
+Or, if you sample at a steady rate, count samples instead of msec, in 1 byte:
+
+  DebounceShift<4> debounce_switch; // changes after 4 samples in a row agree (up to 7)
+
+# Lots of Buttons At Once
+
+DebounceBank debounces all the bits of a port (or any bit-packed snapshot) at once, with a few bitwise operations.
+Call it at a steady rate (from an Every, or a timer interrupt). A bit changes after 4 samples in a row that disagree.
+
+  DebounceBank<uint8_t> buttons; // 8 buttons. uint16_t, uint32_t, uint64_t for more
+  Every sample(5); // so, debounce is 4 * 5 = 20 msec
+
+  void loop() {
+    if ( sample() ) buttons( ~PIND ); // INPUT_PULLUP: pressed is LOW, so invert
+
+    uint8_t pressed = buttons.take_pressed(); // each bit that went 0->1 since the last take_pressed()
+    if (pressed & _BV(3)) { button 3 was pressed }
+    if (buttons.debounced & _BV(4)) { button 4 is down }
+    }
+
 # Decision Guide
 
 Do you have a noisy digital signal? That means the signal is either HIGH or LOW. Or, do you do a conversion to true and false (e.g. "if analogRead() > 60"), which gives a digital signal? And, does it have extra (spurious) changes from HIGH to LOW?
@@ -110,14 +141,14 @@ E.g., wait 5 seconds after the motion stops, then turn off the light.
 template<bool which>
 class DebounceWhich {
   const int duration;
-  unsigned long debounce_expire; // starts at 0, which means a "which" signal will count immediately the first time.
+  unsigned long debounce_expire = 0; // starts at 0, which means a "which" signal will count immediately the first time.
   bool last;
 
   public:
   DebounceWhich(int duration) : duration(duration), last(!which) {}
 
   // FIXME: don't inline
-  bool operator()(bool hilo) const {
+  bool operator()(bool hilo) {
     if (hilo != last) {
 
       // signal changed, deal with it
@@ -130,9 +161,15 @@ class DebounceWhich {
         }
         last = hilo; // we immediately take the change (we just ignore noise after it for a while)
       }
+    }
 
     return last; // always return the debounced value
-    }
+  }
+
+  // msec till a change would be taken, or "never" (~0UL) if it already would be
+  unsigned long next_deadline() {
+    unsigned long now = millis();
+    return now > debounce_expire ? ~0UL : debounce_expire - now + 1;
   }
 
 };
@@ -145,14 +182,14 @@ class DebounceAsymmetric {
 
   const int duration_high;
   const int duration_low;
-  unsigned long debounce_expire; // starts at 0, which means a "which" signal will count immediately the first time.
+  unsigned long debounce_expire = 0; // starts at 0, which means a "which" signal will count immediately the first time.
   bool last;
 
   public:
   DebounceAsymmetric(bool initial, int duration_high, int duration_low) : duration_high(duration_high), duration_low(duration_low), last(initial) {}
 
   // FIXME: don't inline?
-  bool operator()(bool hilo) const {
+  bool operator()(bool hilo) {
     if (hilo != last) {
 
       // signal changed, deal with it
@@ -163,15 +200,20 @@ class DebounceAsymmetric {
         debounce_expire = millis() + (hilo ? duration_high : duration_low); // ignore till expired 
         last = hilo; // we immediately take the change (we just ignore noise after it for a while)
       }
+    }
 
     return last; // always return the debounced value
-    }
+  }
 
+  // msec till a change would be taken, or "never" (~0UL) if it already would be
+  unsigned long next_deadline() {
+    unsigned long now = millis();
+    return now > debounce_expire ? ~0UL : debounce_expire - now + 1;
   }
 
 };
 
-class Debounce : DebounceAsymmetric {
+class Debounce : public DebounceAsymmetric {
   // FIXME: we could use 1 less int by rewriting the asymmetric class
   public:
   Debounce(int debounce_duration) : DebounceAsymmetric(HIGH, debounce_duration, debounce_duration) {}
@@ -182,7 +224,7 @@ class Debounce : DebounceAsymmetric {
 template <boolean which>
 class IgnoreTransientWhich {
   const int duration;
-  unsigned long holding_expire; // starts at 0, which means a "which" signal will count immediately the first time.
+  unsigned long holding_expire = 0; // 0 means not holding
   bool last;
 
   public:
@@ -190,7 +232,7 @@ class IgnoreTransientWhich {
   IgnoreTransientWhich(bool initial, int duration) : duration(duration), last(initial) {}
 
   // FIXME: not inline?
-  bool operator()(bool hilo) const {
+  bool operator()(bool hilo) {
     if (hilo != last) {
       
       // deal with a change (otherwise, it's still the same)
@@ -216,17 +258,24 @@ class IgnoreTransientWhich {
 
       // transient possibly started
       else {
-        holding_expire = millis() + holding_duration;
+        holding_expire = millis() + duration;
       }
 
     }
     else {
-      holding = 0; // if it was a transient, we went back to "last". so, discard the timer
+      holding_expire = 0; // if it was a transient, we went back to "last". so, discard the timer
     }
 
     return last;
   }
-}
+
+  // msec till the held change would be taken (0 if now), or "never" (~0UL) if not holding
+  unsigned long next_deadline() {
+    if (!holding_expire) return ~0UL;
+    unsigned long now = millis();
+    return now > holding_expire ? 0 : holding_expire - now + 1;
+  }
+};
 
 using IgnoreHighTransient = IgnoreTransientWhich<true>;
 using IgnoreLowTransient = IgnoreTransientWhich<false>;
@@ -234,7 +283,7 @@ using IgnoreLowTransient = IgnoreTransientWhich<false>;
 class IgnoreTransients {
   const int duration_high;
   const int duration_low;
-  unsigned long holding_expire; // starts at 0, which means a "which" signal will count immediately the first time.
+  unsigned long holding_expire = 0; // 0 means not holding
   bool last;
 
   public:
@@ -242,7 +291,7 @@ class IgnoreTransients {
   IgnoreTransients(bool initial, int duration) : duration_high(duration), duration_low(duration), last(initial) {}
 
   // FIXME: not inline?
-  bool operator()(bool hilo) const {
+  bool operator()(bool hilo) {
     if (hilo != last) {
       
       // deal with a change (otherwise, it's still the same)
@@ -262,14 +311,183 @@ class IgnoreTransients {
 
       // transient possibly started
       else {
-        holding_expire = millis() + (hilo ? holding_duration_high : holding_duration_low);
+        holding_expire = millis() + (hilo ? duration_high : duration_low);
       }
 
     }
     else {
-      holding = 0; // if it was a transient, we went back to "last". so, discard the timer
+      holding_expire = 0; // if it was a transient, we went back to "last". so, discard the timer
     }
 
     return last;
   }
-}
+
+  // msec till the held change would be taken (0 if now), or "never" (~0UL) if not holding
+  unsigned long next_deadline() {
+    if (!holding_expire) return ~0UL;
+    unsigned long now = millis();
+    return now > holding_expire ? 0 : holding_expire - now + 1;
+  }
+};
+
+class _DebouncePacked {
+  // the state for the ...Of<> classes, in 16 bits:
+  // the debounced value, "in the debounce window", and a 14 bit millis() of when the window started
+  protected:
+  uint16_t packed;
+  static const uint16_t Last = 0x8000;
+  static const uint16_t Window = 0x4000;
+  static const uint16_t Stamp = 0x3FFF;
+
+  _DebouncePacked(bool initial) : packed(initial ? Last : 0) {}
+
+  bool last() const { return packed & Last; }
+
+  // are we in the window that started at "Stamp"? Forgets the window when it's over, so the 14 bits don't roll over on us
+  bool in_window(unsigned int duration) {
+    if ( !(packed & Window) ) return false;
+    if ( (((uint16_t) millis() - packed) & Stamp) > duration ) {
+      packed &= ~Window;
+      return false;
+    }
+    return true;
+  }
+
+  void take(bool hilo, bool start_window) {
+    packed = (hilo ? Last : 0) | (start_window ? Window | ((uint16_t) millis() & Stamp) : 0);
+  }
+
+  unsigned long window_left(unsigned int duration) {
+    if ( !in_window(duration) ) return ~0UL;
+    return duration - (((uint16_t) millis() - packed) & Stamp) + 1;
+  }
+};
+
+template <unsigned int duration_high, unsigned int duration_low>
+class DebounceAsymmetricOf : public _DebouncePacked {
+  // DebounceAsymmetric, with the durations at compile time
+  static_assert(duration_high <= _DebouncePacked::Stamp && duration_low <= _DebouncePacked::Stamp, "DebounceAsymmetricOf<> durations have to be < 16384");
+
+  public:
+  DebounceAsymmetricOf(bool initial = HIGH) : _DebouncePacked(initial) {}
+
+  bool operator()(bool hilo) {
+    // always look, so a finished window is forgotten
+    bool window = in_window( last() ? duration_high : duration_low );
+    if (hilo != last() && !window) {
+      take(hilo, true); // we immediately take the change (we just ignore noise after it for a while)
+    }
+    return last();
+  }
+
+  unsigned long next_deadline() { return window_left( last() ? duration_high : duration_low ); }
+};
+
+template <unsigned int duration>
+using DebounceOf = DebounceAsymmetricOf<duration, duration>;
+
+template <bool which, unsigned int duration>
+class DebounceWhichOf : public _DebouncePacked {
+  // DebounceWhich, with the duration at compile time
+  static_assert(duration <= _DebouncePacked::Stamp, "DebounceWhichOf<> duration has to be < 16384");
+
+  public:
+  DebounceWhichOf() : _DebouncePacked(!which) {}
+
+  bool operator()(bool hilo) {
+    bool window = in_window(duration);
+    if (hilo != last() && !window) {
+      take(hilo, hilo == which); // only the change towards "which" is noisy
+    }
+    return last();
+  }
+
+  unsigned long next_deadline() { return window_left(duration); }
+};
+
+template <unsigned int duration>
+using DebounceHighOf = DebounceWhichOf<true, duration>;
+template <unsigned int duration>
+using DebounceLowOf = DebounceWhichOf<false, duration>;
+
+template <byte samples>
+class DebounceShift {
+  // An integrator: changes when the last "samples" samples agree. Call at a steady rate.
+  // bit 7 is the debounced value, bits 0..6 are the last samples
+  static_assert(samples >= 1 && samples <= 7, "DebounceShift<1..7>");
+  static const byte Mask = (1 << samples) - 1;
+  byte bits;
+
+  public:
+  DebounceShift(bool initial = HIGH) : bits(initial ? 0xFF : 0) {}
+
+  bool operator()(bool hilo) {
+    bits = (bits & 0x80) | ((bits << 1) & 0x7F) | hilo;
+    if ( (bits & Mask) == Mask ) bits |= 0x80;
+    else if ( (bits & Mask) == 0 ) bits &= ~0x80;
+    return bits & 0x80;
+  }
+};
+
+// What they cost
+static_assert( sizeof(DebounceOf<10>) == 2, "DebounceOf<> should be 2 bytes" );
+static_assert( sizeof(DebounceHighOf<10>) == 2, "DebounceHighOf<> should be 2 bytes" );
+static_assert( sizeof(DebounceShift<4>) == 1, "DebounceShift<> should be 1 byte" );
+
+template <typename T> // uint8_t, uint16_t, uint32_t, uint64_t: 1 bit per input
+class DebounceBank {
+  // "Vertical counters": each bit has a 2 bit counter, spread across cnt0 & cnt1.
+  // The counter runs while the raw bit disagrees with the debounced bit, and resets when it agrees.
+  // After 4 disagreeing samples, the debounced bit flips. All bits in parallel.
+  // update() is interrupt-safe, read .debounced and take_...() with that in mind (they are volatile, take_ turns interrupts off, then restores them).
+
+  T cnt0 = 0;
+  T cnt1 = 0;
+
+  public:
+  volatile T debounced;
+  volatile T pressed = 0; // went 0->1, accumulates till take_pressed()
+  volatile T released = 0; // went 1->0, accumulates till take_released()
+
+  DebounceBank(T initial = 0) : debounced(initial) {}
+
+  // returns the bits that changed this time
+  T update(T raw) {
+    T delta = raw ^ debounced;
+    cnt1 = (cnt1 ^ cnt0) & delta;
+    cnt0 = ~cnt0 & delta;
+    T toggle = delta & ~(cnt0 | cnt1); // counted to 4 (wrapped to 0)
+    debounced ^= toggle;
+    pressed |= toggle & debounced;
+    released |= toggle & ~debounced;
+    return toggle;
+  }
+
+  // like the other Debounce's: debounced value
+  T operator()(T raw) {
+    update(raw);
+    return debounced;
+  }
+
+  T take_pressed() { return take(pressed); }
+  T take_released() { return take(released); }
+
+  private:
+  static T take(volatile T &bits) {
+    // with interrupts off, and back to what they were: you might call us with them off (or from an interrupt)
+#ifdef __AVR__
+    uint8_t sreg = SREG;
+    cli();
+#else
+    noInterrupts();
+#endif
+    T was = bits;
+    bits = 0;
+#ifdef __AVR__
+    SREG = sreg;
+#else
+    interrupts();
+#endif
+    return was;
+  }
+};
@@ -89,6 +89,24 @@
     // Prints a,b,c,d,a,b,c,d, with a delay of 100 between
     if ( t1() ) { Serial.println( t1.sequence() ) };
 
+  * Pattern of times
+    static const unsigned long pattern[] = { 300, 600, 1000, 1500 };
+    static Every::Pattern timed_pattern(array_size(pattern), pattern);
+    // or, compile-time, in flash, and 1 byte of .state:
+    static Every::PatternOf<300, 600, 1000, 1500> timed_pattern;
+    static Every::Heartbeat heartbeat; // 150,250,150,700
+
+    if ( timed_pattern() ) { digitalWrite(LED_BUILTIN, timed_pattern.state % 2); }
+
+  * Fixed interval
+    static Every::Fixed<128> t1; // interval is a compile-time constant, smaller/faster code
+
+    * Details
+      The drift correction needs "how late are we?", which is a division (slow on AVR).
+      Every::Fixed<n> makes that a mask for powers of 2 (and a division by a constant otherwise).
+      Every and EveryMicros avoid the division when they are tested within one interval of expiring (the usual case).
+      Or, #define EVERY_POW2_INTERVALS before the #include, and all intervals have to be powers of 2 (mask instead of division).
+
   * Use lambda, or a function, or functor
  
     boolean happened = t1( &doit } );
@@ -102,6 +120,34 @@
 
       functions/lambdas/functors will be called with no arguments.
       
+  * Bind the lambda once, dispatch them all at once
+    void setup() {
+      t1.on( []() { do it; } );
+      t2.on( [somepointer]() { do it with somepointer; } );
+      }
+
+    void loop() {
+      Every::run_all(); // calls the .on() of each one that fired
+      }
+
+    * Details
+      The lambda is copied into one of EVERY_CALLBACKS slots (no new, no std::function),
+      which only has room for EVERY_CALLBACK_BYTES of captures.
+      run_all() also does Every::Scheduler::run() and Every::Interrupt::drain(), so register them too
+      and run_all() doesn't have to look at the clock for each one.
+      t1.off() to unbind.
+
+  * How long till something needs doing? (e.g. to sleep)
+    unsigned long ms = t1.next_deadline(); // 0 means due now
+    unsigned long ms = Every::until_next(); // first of everything registered (Scheduler, Interrupt, .on())
+    unsigned long ms = Every::until_next(t1, timer2, blinker, debounce); // and these too
+    if (ms == Every::Never) { nothing is waiting } // e.g. Timer that isn't running
+
+    * Details
+      Every, Timer, Blinker, and the Debounce/IgnoreTransient classes have next_deadline().
+      A debouncer only needs you during its debounce/holding period, otherwise it's Never (it waits for the input to change,
+      so wake on the pin-change too).
+
   * Resetting
     if (tmetoreset) t1.reset(); // next in 100 msec from this call
     // t1.reset(true); // the next t1() will be true ("immediate")
@@ -116,6 +162,85 @@
     millis() - t1.last;
     
 
+  * One clock read per loop: EVERY_FRAME_CLOCK
+    Every t1() reads millis() for itself (and on AVR, each read turns interrupts off/on).
+    Timers that should fire together can disagree by a msec.
+    Instead, read the clock once per loop, and all the timers use that:
+
+    #define EVERY_FRAME_CLOCK // before the #include
+    #include <every.h>
+
+    void setup() {
+      ...
+      Every::tick(); // so the .reset()'s see the current time
+      t1.reset();
+      }
+
+    void loop() {
+      Every::tick(); // first thing! (and EveryMicros::tick() if you use those)
+      if ( t1() ) { ... }
+      if ( t2() ) { ... } // same "now" as t1
+      }
+
+    * Details
+      Every, Timer, and Every::Scheduler use Every::clock(). EveryMicros uses EveryMicros::clock().
+      Without EVERY_FRAME_CLOCK, clock() is just millis() (or micros()), and tick() does nothing.
+      With it, the clock doesn't move between tick()'s: a long loop() is seen as late,
+      and the drift correction catches up at the next tick().
+
+  * Many timers: Every::Scheduler
+    Each t1() normally reads millis() and does the arithmetic, even when nothing is due.
+    With dozens of timers, register them and let one timer-wheel do the work:
+
+    static Every t1(100);
+    static Every::Pattern heartbeat;
+    static Timer timeout(5000);
+
+    void setup() {
+      ...
+      Every::Scheduler::add(t1); // also does the .reset()
+      Every::Scheduler::add(heartbeat);
+      Every::Scheduler::add(timeout);
+      }
+
+    void loop() {
+      Every::Scheduler::run(); // once per loop, before any t1()
+      if ( t1() ) { ... } // same as before, but just tests a flag
+      }
+
+    Asking each timer is still a call per timer per loop. To only touch the ones that fired:
+      Every::Scheduler::run();
+      while (EveryScheduled *t = Every::Scheduler::take()) { // already "noticed", like t1() said true
+        if (t == &t1) { ... }
+        else if (t == &timeout) { ... }
+        }
+
+    * Details
+      The cost of run() is proportional to the number of timers that expired (plus a little per msec that went by),
+      not to the number of timers. Likewise take(). Polling each t1() is a flag test per timer.
+      A registered t1() only says true after run() has noticed it. So, call run() every loop.
+      If you change .interval on a registered timer, do a .reset() (or the old interval is used for the current wait).
+      Unregistered timers work as always.
+      EveryMicros can't be registered (the wheel counts msec).
+      Takes 3 more bytes per object, and (2 * 16 * 3) + 10 bytes for the wheel (see EVERY_WHEEL_BITS).
+      Timers longer than 16*16*16 msec wait on an overflow list, which is checked every 4 seconds.
+
+  * Not delayed by a slow loop(): Every::Interrupt
+    If loop() blocks for a while (Serial flush, NeoPixel show()), an interrupt can still notice the
+    Every's on time, and queue them for loop() to run:
+
+    Every::Interrupt::add(t1); // in setup()
+    Every::Interrupt::begin();
+
+    void loop() {
+      Every::Interrupt::drain(); // once per loop, before any t1()
+      t1( []() { ... } ); // same as before, the lambda runs here (not in the interrupt)
+      }
+
+    * Details
+      See class Every::Interrupt below for EVERY_INTERRUPT_TIMER0 (AVR), or hooking up your own timer interrupt.
+      An Every can be registered with Every::Scheduler or Every::Interrupt, not both.
+
   ???
 
   A timeline: n1,n2,n3 => event1,event2,event3
@@ -125,18 +250,117 @@
 //#include <Streaming.h>
 //#define DEBUG Serial << '[' << millis() << "] "
 
-class Every {
+// Every::Scheduler is a hierarchical timer-wheel: EVERY_WHEEL_LEVELS of 2^EVERY_WHEEL_BITS slots.
+#ifndef EVERY_WHEEL_BITS
+#define EVERY_WHEEL_BITS 4 // 16 slots per level
+#endif
+#ifndef EVERY_WHEEL_LEVELS
+#define EVERY_WHEEL_LEVELS 3 // 16*16*16 msec before the overflow list
+#endif
+
+// Every::Interrupt sizes
+#ifndef EVERY_INTERRUPT_TIMERS
+#define EVERY_INTERRUPT_TIMERS 8
+#endif
+#ifndef EVERY_INTERRUPT_QUEUE
+#define EVERY_INTERRUPT_QUEUE 8 // power of 2
+#endif
+
+// Interrupts off, and back to what they were (not just on). AVR only, others just do noInterrupts()/interrupts()
+#ifdef __AVR__
+#define EVERY_ATOMIC_BEGIN { uint8_t _every_sreg = SREG; cli();
+#define EVERY_ATOMIC_END SREG = _every_sreg; }
+#else
+#define EVERY_ATOMIC_BEGIN { noInterrupts();
+#define EVERY_ATOMIC_END interrupts(); }
+#endif
+
+// Every::on() sizes
+#ifndef EVERY_CALLBACKS
+#define EVERY_CALLBACKS 8 // how many .on()'s
+#endif
+#ifndef EVERY_CALLBACK_BYTES
+#define EVERY_CALLBACK_BYTES (2 * sizeof(void*)) // room for a lambda's captures
+#endif
+// trivially copyable implies it, but say so where the compiler has the builtin (not avr-gcc 7)
+#if defined(__has_builtin)
+#if __has_builtin(__is_trivially_destructible)
+#define _EVERY_TRIVIALLY_DESTRUCTIBLE(T) __is_trivially_destructible(T)
+#endif
+#endif
+#ifndef _EVERY_TRIVIALLY_DESTRUCTIBLE
+#define _EVERY_TRIVIALLY_DESTRUCTIBLE(T) true
+#endif
+
+class EveryScheduled {
+  // The bookkeeping that lets Every::Scheduler keep us in its wheel.
+  // Every and Timer are these.
+  public:
+    // Queued, Held, ByInterrupt are for Every::Interrupt
+    enum { Registered = 1, Due = 2, Periodic = 4, Queued = 8, Held = 16, ByInterrupt = 32 };
+
+    EveryScheduled *_wheel_next = nullptr;
+    byte _wheel_flags = 0;
+
+    // t1(): true once when it fires (for a registered one: when run() found it due)
+    virtual boolean operator()() = 0;
+    // millis() when we are next due
+    virtual unsigned long _deadline() = 0;
+    // The wheel thinks we are due, so do the bookkeeping as of "now".
+    // false means "not yet" (e.g. the interval got longer)
+    virtual boolean _expire(unsigned long now) = 0;
+};
+
+class Every;
+
+struct _EveryCallback {
+  // a slot for Every::on(). The callable is copied into .store, no new/std::function
+  Every *owner; // nullptr is unused
+  void (*call)(void *store);
+  union {
+    void *align_p;
+    unsigned long align_ul;
+    double align_d;
+    byte store[EVERY_CALLBACK_BYTES];
+  };
+};
+
+class Every : public EveryScheduled {
   public:
     // everthing public
     unsigned long last; // last time we fired
     unsigned long interval = 1000; // "delay" till next firing
 
+#ifdef EVERY_FRAME_CLOCK
+    // millis() as of the last tick(). see EVERY_FRAME_CLOCK at the top
+    static unsigned long &_frame() { static unsigned long ms; return ms; }
+    static unsigned long clock() { return _frame(); }
+    static void tick() { _frame() = millis(); }
+#else
+    static unsigned long clock() { return millis(); }
+    static void tick() {}
+#endif
+
+    // diff % interval, i.e. how late we are, for the drift correction.
+    // The % is a 32 bit software division on AVR, so avoid it:
+    // usually we are checked within one interval of expiring, which is just a subtraction.
+    // #define EVERY_POW2_INTERVALS if all your intervals are powers of 2, and it's a mask.
+    // See Every::Fixed for a compile-time interval.
+    static unsigned long _drift(unsigned long diff, unsigned long interval) {
+#ifdef EVERY_POW2_INTERVALS
+      return diff & (interval - 1);
+#else
+      diff -= interval;
+      return diff < interval ? diff : diff % interval;
+#endif
+    }
+
     // set interval at x() time, default 1000
     Every(bool now = false) : Every( 1000, now) {}
 
     Every(int interval, bool now = false) : Every( (unsigned long) interval, now) {}
     Every(unsigned long interval, bool now = false) : interval(interval) {
-      last = millis(); // so, would wait for interval
+      last = clock(); // so, would wait for interval
 
       if (now) {
         last -= interval; // adjust to "already expired"
@@ -144,12 +368,19 @@ class Every {
     }
 
     virtual boolean operator()() {
-      // lots of this class means lots of calls to millis()
-      unsigned long now = millis(); // minimize drift due to this fn
+      if (_wheel_flags & Registered) {
+        // Every::Scheduler::run() already did the work, we just notice
+        if ( ! (_wheel_flags & Due) ) return false;
+        _wheel_flags &= ~Due;
+        return true;
+      }
+
+      // lots of this class means lots of calls to millis(), unless EVERY_FRAME_CLOCK
+      unsigned long now = clock(); // minimize drift due to this fn
       unsigned long diff = now - last;
       
       if (diff >= interval) {
-        unsigned long drift = diff % interval;
+        unsigned long drift = _drift(diff, interval);
         // DEBUG << "drift " << last << " now " << now << " d: " << drift << endl;
         last = now;
         last -= drift;
@@ -162,11 +393,11 @@ class Every {
     // so you can use "bare" numbers like 100 for 100msec
     boolean operator()(int x_interval) { return (*this)( (unsigned long) x_interval); }
     boolean operator()(unsigned long x_interval) {
-      unsigned long now = millis(); // minimize drift due to this fn
+      unsigned long now = clock(); // minimize drift due to this fn
       unsigned long diff = now - last;
 
       if (diff >= x_interval) {
-        unsigned long drift = diff % x_interval;
+        unsigned long drift = _drift(diff, x_interval);
         //Serial << "drift " << last << " now " << now << " d: " << drift << endl;
         last = now;
         last -= drift;
@@ -186,21 +417,86 @@ class Every {
       return hit;
     }
 
-    // sadly, the 'virtual' also prevents optimizing away an unused 'interval' instance-var
-    virtual void reset(boolean now=false) {
-      last = millis();
-      if (now) last -= interval;
+    // Bind a callback once, then Every::run_all() calls it when we fire:
+    //    t1.on( []() { do it; } ); // in setup()
+    // The callable is copied into a fixed slot (see EVERY_CALLBACKS, EVERY_CALLBACK_BYTES),
+    // so it must be small, and trivially copyable (lambdas capturing pointers/numbers are).
+    // Returns false if there's no slot left.
+    template <typename T>
+    boolean on(T lambdaF) {
+      static_assert( sizeof(T) <= EVERY_CALLBACK_BYTES, "Every::on() lambda captures too much, see EVERY_CALLBACK_BYTES" );
+      static_assert( __is_trivially_copyable(T) && _EVERY_TRIVIALLY_DESTRUCTIBLE(T), "Every::on() needs a trivially copyable lambda/functor" );
+
+      _EveryCallback *slot = _callback_slot(this);
+      if (!slot) slot = _callback_slot(nullptr);
+      if (!slot) return false;
+
+      memcpy(slot->store, &lambdaF, sizeof(T));
+      slot->call = [](void *store) { (*(T*)store)(); };
+      slot->owner = this;
+      return true;
+    }
+    void off() {
+      _EveryCallback *slot = _callback_slot(this);
+      if (slot) slot->owner = nullptr;
+    }
+
+    static _EveryCallback *_callbacks() { static _EveryCallback slots[EVERY_CALLBACKS]; return slots; }
+    static _EveryCallback *_callback_slot(Every *owner) {
+      _EveryCallback *slots = _callbacks();
+      for (byte i = 0; i < EVERY_CALLBACKS; i++) {
+        if (slots[i].owner == owner) return &slots[i];
+      }
+      return nullptr;
     }
+
+    static void run_all(); // after Every::Interrupt
+
+    static const unsigned long Never = ~0UL; // for next_deadline()
+
+    // msec till we fire, 0 if we are due now. So you can sleep till then.
+    unsigned long next_deadline() {
+      if (_wheel_flags & Due) return 0;
+      unsigned long diff = clock() - last;
+      return diff >= interval ? 0 : interval - diff;
+    }
+
+    // msec till the first of the registered (Scheduler, Interrupt, .on()) timers fires, and any others you list:
+    //    Every::until_next(); Every::until_next(t1, blinker, debounce);
+    // anything with a next_deadline() works. Every::Never if nothing is waiting.
+    static unsigned long until_next(); // after Every::Interrupt
+    template <typename T, typename... R>
+    static unsigned long until_next(T &t, R&... rest) {
+      unsigned long a = t.next_deadline();
+      unsigned long b = until_next(rest...);
+      return a < b ? a : b;
+    }
+
+    // sadly, the 'virtual' also prevents optimizing away an unused 'interval' instance-var
+    virtual void reset(boolean now=false); // after Every::Scheduler
     void reset(unsigned long interval, boolean now=false) { 
       this->interval=interval; 
       reset(now); 
       }
 
+    unsigned long _deadline() { return last + interval; }
+    boolean _expire(unsigned long now) {
+      unsigned long diff = now - last;
+      if (diff < interval) return false;
+      last = now - _drift(diff, interval); // same drift correction as ()
+      return true;
+    }
+
     class Toggle;
     class Pattern;
+    template <unsigned long... Ns> class PatternOf;
+    typedef PatternOf<150,250,150,700> Heartbeat; // same as the default Pattern
+    template <unsigned long N> class Fixed;
 #ifdef SPARK_PLATFORM
     class Timer;
 #endif
+    class Scheduler;
+    class Interrupt;
 };
 
 class EveryMicros {
@@ -209,12 +505,22 @@ class EveryMicros {
     unsigned long last; // last time we fired
     unsigned long interval = 1000; // "delay" till next firing
 
+#ifdef EVERY_FRAME_CLOCK
+    // micros() as of the last tick()
+    static unsigned long &_frame() { static unsigned long us; return us; }
+    static unsigned long clock() { return _frame(); }
+    static void tick() { _frame() = micros(); }
+#else
+    static unsigned long clock() { return micros(); }
+    static void tick() {}
+#endif
+
     // set interval at x() time, default 1000
     EveryMicros(bool now = false) : EveryMicros( 1000, now) {}
 
     EveryMicros(int interval, bool now = false) : EveryMicros( (unsigned long) interval, now) {}
     EveryMicros(unsigned long interval, bool now = false) : interval(interval) {
-      last = micros(); // so, would wait for interval
+      last = clock(); // so, would wait for interval
 
       if (now) {
         last -= interval; // adjust to "already expired"
@@ -222,12 +528,12 @@ class EveryMicros {
     }
 
     virtual boolean operator()() {
-      // lots of this class means lots of calls to micros()
-      unsigned long now = micros(); // minimize drift due to this fn
+      // lots of this class means lots of calls to micros(), unless EVERY_FRAME_CLOCK
+      unsigned long now = clock(); // minimize drift due to this fn
       unsigned long diff = now - last;
       
       if (diff >= interval) {
-        unsigned long drift = diff % interval;
+        unsigned long drift = Every::_drift(diff, interval);
         // DEBUG << "drift " << last << " now " << now << " d: " << drift << endl;
         last = now;
         last -= drift;
@@ -240,11 +546,11 @@ class EveryMicros {
     // so you can use "bare" numbers like 100 for 100msec
     boolean operator()(int x_interval) { return (*this)( (unsigned long) x_interval); }
     boolean operator()(unsigned long x_interval) {
-      unsigned long now = micros(); // minimize drift due to this fn
+      unsigned long now = clock(); // minimize drift due to this fn
       unsigned long diff = now - last;
 
       if (diff >= x_interval) {
-        unsigned long drift = diff % x_interval;
+        unsigned long drift = Every::_drift(diff, x_interval);
         //Serial << "drift " << last << " now " << now << " d: " << drift << endl;
         last = now;
         last -= drift;
@@ -266,7 +572,7 @@ class EveryMicros {
 
     // sadly, the 'virtual' also prevents optimizing away an unused 'interval' instance-var
     virtual void reset(boolean now=false) {
-      last = micros();
+      last = clock();
       if (now) last -= interval;
     }
     void reset(unsigned long interval, boolean now=false) { 
@@ -309,6 +615,46 @@ class Every::Toggle : public Every { // not really a ...Sequence
 
 };
 
+template <unsigned long N>
+class Every::Fixed : public Every {
+  // The interval is a compile-time constant:
+  //    static Every::Fixed<128> t1;
+  // So the drift correction is a mask for powers of 2, and at worst a division by a constant.
+  // Changing .interval does nothing (except confuse Every::Scheduler).
+  static_assert(N > 0, "Every::Fixed<0> would always be expired");
+
+  public:
+    Fixed(bool now = false) : Every(N, now) {}
+
+    static unsigned long _fixed_drift(unsigned long diff) {
+      if ( (N & (N - 1)) == 0 ) return diff & (N - 1);
+      diff -= N;
+      return diff < N ? diff : diff % N;
+    }
+
+    using Every::operator(); // in every subclass if you add a ()
+
+    boolean operator()() {
+      if (_wheel_flags & Registered) return Every::operator()();
+
+      unsigned long now = clock();
+      unsigned long diff = now - last;
+      if (diff >= N) {
+        last = now - _fixed_drift(diff);
+        return true;
+      }
+      return false;
+    }
+
+    unsigned long _deadline() { return last + N; }
+    boolean _expire(unsigned long now) {
+      unsigned long diff = now - last;
+      if (diff < N) return false;
+      last = now - _fixed_drift(diff);
+      return true;
+    }
+};
+
 class Every::Pattern : public Every {
     // has a pattern of msecs
     // e.g.
@@ -365,11 +711,69 @@ class Every::Pattern : public Every {
     }
 };
 
+// for Every::PatternOf: the largest value, and the smallest unsigned type that holds it
+constexpr unsigned long _every_max(unsigned long a) { return a; }
+template <typename... R>
+constexpr unsigned long _every_max(unsigned long a, R... rest) { return a > _every_max(rest...) ? a : _every_max(rest...); }
+constexpr unsigned long _every_first(unsigned long a) { return a; }
+template <typename... R>
+constexpr unsigned long _every_first(unsigned long a, R...) { return a; }
+
+template <bool fits_byte, bool fits_word> struct _EveryUint { typedef uint32_t type; };
+template <bool fits_word> struct _EveryUint<true, fits_word> { typedef uint8_t type; };
+template <> struct _EveryUint<false, true> { typedef uint16_t type; };
+
+inline unsigned long _every_pgm_read(const uint8_t *p) { return pgm_read_byte(p); }
+inline unsigned long _every_pgm_read(const uint16_t *p) { return pgm_read_word(p); }
+inline unsigned long _every_pgm_read(const uint32_t *p) { return pgm_read_dword(p); }
+
+template <unsigned long... Ns>
+class Every::PatternOf : public Every {
+    // Like Every::Pattern, but the pattern is compile-time, and lives in flash (PROGMEM):
+    //    static Every::PatternOf<300, 600, 1000, 1500> timed_pattern;
+    //    static Every::Heartbeat heartbeat; // the default Pattern
+    // Each msec value is stored as the smallest type that fits the largest one (byte, word, or long),
+    // and the .state is 1 byte. So it's cheaper for lots of status LEDs.
+    static_assert(sizeof...(Ns) > 0, "Every::PatternOf<> needs at least 1 interval");
+    static_assert(sizeof...(Ns) <= 255, "Every::PatternOf<...> .state is a byte");
+
+  public:
+    typedef typename _EveryUint< _every_max(Ns...) <= 0xFF, _every_max(Ns...) <= 0xFFFF >::type IntervalT;
+    static const IntervalT _pattern[sizeof...(Ns)] PROGMEM;
+    static const byte seq_count = sizeof...(Ns);
+
+    byte state = 0; // because if(every()) will increment before you get pattern()
+
+    PatternOf(bool now = false) : Every( _every_first(Ns...), now) {}
+
+    static unsigned long pattern(byte i) { return _every_pgm_read( &_pattern[i] ); }
+
+    using Every::operator(); // in every subclass if you add a ()
+
+    boolean operator()() {
+      boolean hit = Every::operator()();
+      if (hit) {
+        if (++state == seq_count) state = 0;
+        interval = pattern(state);
+      }
+      return hit;
+    }
+
+    virtual void reset(boolean now=false) {
+      state = 0;
+      interval = pattern(state);
+      Every::reset(now);
+    }
+};
+
+template <unsigned long... Ns>
+const typename Every::PatternOf<Ns...>::IntervalT Every::PatternOf<Ns...>::_pattern[sizeof...(Ns)] PROGMEM = { Ns... };
+
 #ifdef SPARK_PLATFORM
 // particle.io beasties have a Timer class
-class Every::Timer {
+class Every::Timer : public EveryScheduled {
 #else
-class Timer { 
+class Timer : public EveryScheduled { 
 #endif
   // True, once, after n millis
   // NB: Slightly different methods than Every
@@ -378,11 +782,19 @@ class Timer {
     boolean running;
     unsigned long interval;
 
-    Timer(unsigned long interval, boolean run=true) : last(millis()), running(run), interval(interval) {}
+    Timer(unsigned long interval, boolean run=true) : last(Every::clock()), running(run), interval(interval) {}
 
     virtual boolean operator()() {
+      if (_wheel_flags & Registered) {
+        // Every::Scheduler::run() noticed for us
+        if ( ! (_wheel_flags & Due) ) return false;
+        _wheel_flags &= ~Due;
+        running = false;
+        return true;
+      }
+
       if ( running ) {
-        if (millis() - last >= interval) {
+        if (Every::clock() - last >= interval) {
           running = false; // expires, and stays expired
           return true;
         }
@@ -426,10 +838,454 @@ class Timer {
       return false;
     }
 
-    void reset() {
-      running = true;
-      last = millis();
-      }
+    void reset(); // after Every::Scheduler
+
+    // msec till we fire, 0 if due now, Every::Never if not running
+    unsigned long next_deadline() {
+      if (_wheel_flags & Due) return 0;
+      if (!running) return Every::Never;
+      unsigned long diff = Every::clock() - last;
+      return diff >= interval ? 0 : interval - diff;
+    }
     void reset(int interval) { this->interval=(unsigned long) interval; reset(); }
     void reset(unsigned long interval) { this->interval=interval; reset(); }
+
+    unsigned long _deadline() { return last + interval; }
+    boolean _expire(unsigned long now) { return running && now - last >= interval; }
+};
+
+class Every::Scheduler {
+  // A hierarchical timer-wheel, so a loop() with many timers only does work for the ones that expired.
+  // Level 0 has a slot per msec, level 1 a slot per 16 msec, etc. A timer sits in the slot of its deadline,
+  // and moves down a level ("cascades") as the wheel turns toward it.
+  // There is only one (static) wheel, there's only one millis().
+  // See "Many timers" at the top.
+
+  public:
+    static const unsigned int Slots = 1 << EVERY_WHEEL_BITS;
+    static const unsigned int SlotMask = Slots - 1;
+
+    struct Wheel {
+      unsigned long current; // next msec to process
+      unsigned int count; // registered
+      EveryScheduled *slots[EVERY_WHEEL_LEVELS][Slots];
+      EveryScheduled *overflow; // too far in the future for the wheel
+      EveryScheduled *due; // expired, waiting for t1() to notice
+    };
+    // zero-initialized static, so no constructor code
+    static Wheel &wheel() { static Wheel w; return w; }
+
+    static void add(Every &t) {
+      if (t._wheel_flags & EveryScheduled::ByInterrupt) return; // already Every::Interrupt's
+      t.reset();
+      _add(t, EveryScheduled::Periodic);
+    }
+    static void add(Timer &t) { t.reset(); _add(t, 0); }
+
+    static void remove(EveryScheduled &t) {
+      if ( !(t._wheel_flags & EveryScheduled::Registered) ) return;
+      _unlink(t);
+      t._wheel_flags = 0;
+      wheel().count--;
+    }
+
+    static void run() {
+      // once per loop()
+      Wheel &w = wheel();
+      if (w.count == 0) return;
+
+      unsigned long now = Every::clock();
+      _rearm();
+
+      // turn the wheel through each msec that went by
+      while ( (long)(now - w.current) >= 0 ) {
+        unsigned int idx = w.current & SlotMask;
+        if (idx == 0) {
+          // level 0 went all the way around, pull the next slot of level 1 down, etc.
+          byte level = 1;
+          while ( _cascade(level) == 0 && level < EVERY_WHEEL_LEVELS ) level++;
+        }
+
+        EveryScheduled *t = w.slots[0][idx];
+        w.slots[0][idx] = nullptr;
+        while (t) {
+          EveryScheduled *next = t->_wheel_next;
+          if (t->_expire(now)) {
+            t->_wheel_flags |= EveryScheduled::Due;
+            _push(w.due, t);
+          }
+          else {
+            _insert(*t, t->_deadline()); // not yet
+          }
+          t = next;
+        }
+
+        w.current++;
+      }
+    }
+
+    static EveryScheduled *take() {
+      // the next timer that run() found due, nullptr if no more. It's noticed (its t1() was called for you).
+      Wheel &w = wheel();
+      while (w.due) {
+        EveryScheduled *t = w.due;
+        w.due = t->_wheel_next;
+        boolean due = t->_wheel_flags & EveryScheduled::Due;
+        if (due) (*t)(); // a Pattern moves to its next interval, etc.
+        // same as _rearm()
+        if (t->_wheel_flags & EveryScheduled::Periodic) _insert(*t, t->_deadline());
+        if (due) return t;
+      }
+      return nullptr;
+    }
+
+    static unsigned long until_next() {
+      // msec till the first registered timer is due, Every::Never if none
+      Wheel &w = wheel();
+      if (w.count == 0) return Every::Never;
+      unsigned long now = Every::clock();
+      unsigned long best = Every::Never;
+
+      for (EveryScheduled *t = w.due; t; t = t->_wheel_next) {
+        if (t->_wheel_flags & EveryScheduled::Due) return 0;
+        // t1() noticed it, it goes back in the wheel at the next run(). A Timer doesn't.
+        if ( (t->_wheel_flags & EveryScheduled::Periodic) && _nearer(t, now, best) ) return 0;
+      }
+
+      // the first non-empty slot of each level (they aren't ordered across levels), and the overflow
+      for (byte level = 0; level <= EVERY_WHEEL_LEVELS; level++) {
+        EveryScheduled *t = w.overflow;
+        if (level < EVERY_WHEEL_LEVELS) {
+          unsigned int idx = (w.current >> (level * EVERY_WHEEL_BITS)) & SlotMask;
+          // a higher level's current slot is the furthest away, unless we are about to cascade it
+          if ( level > 0 && (w.current & ((1UL << (level * EVERY_WHEEL_BITS)) - 1)) ) idx++;
+          t = nullptr;
+          for (unsigned int i = 0; i < Slots && !t; i++) t = w.slots[level][ (idx + i) & SlotMask ];
+        }
+        for (; t; t = t->_wheel_next) {
+          if ( _nearer(t, now, best) ) return 0;
+        }
+      }
+      return best;
+    }
+
+    // rest is internal
+
+    static boolean _nearer(EveryScheduled *t, unsigned long now, unsigned long &best) {
+      // for until_next(): true if t is due now, else best = min(best, till t is due)
+      long left = t->_deadline() - now;
+      if (left <= 0) return true;
+      if ( (unsigned long) left < best ) best = left;
+      return false;
+    }
+
+    static void _add(EveryScheduled &t, byte flags) {
+      Wheel &w = wheel();
+      if (t._wheel_flags & EveryScheduled::Registered) return; // already, .reset() re-inserted it
+      if (w.count == 0) w.current = Every::clock();
+      w.count++;
+      t._wheel_flags = EveryScheduled::Registered | flags;
+      _insert(t, t._deadline());
+    }
+
+    static void _reschedule(EveryScheduled &t) {
+      // from .reset(), which changed the deadline
+      _unlink(t);
+      t._wheel_flags &= ~EveryScheduled::Due;
+      _insert(t, t._deadline());
+    }
+
+    static void _push(EveryScheduled *&list, EveryScheduled *t) {
+      t->_wheel_next = list;
+      list = t;
+    }
+
+    static void _insert(EveryScheduled &t, unsigned long deadline) {
+      Wheel &w = wheel();
+      long delta = deadline - w.current;
+      if (delta < 0) { deadline = w.current; delta = 0; } // late, so next msec
+
+      unsigned long span = Slots;
+      for (byte level = 0; level < EVERY_WHEEL_LEVELS; level++, span <<= EVERY_WHEEL_BITS) {
+        if ( (unsigned long) delta < span ) {
+          _push( w.slots[level][ (deadline >> (level * EVERY_WHEEL_BITS)) & SlotMask ], &t );
+          return;
+        }
+      }
+      _push(w.overflow, &t);
+    }
+
+    static unsigned int _cascade(byte level) {
+      // re-insert the slot of "level" that we are entering, returns its index
+      Wheel &w = wheel();
+      EveryScheduled **list;
+      unsigned int idx;
+
+      if (level == EVERY_WHEEL_LEVELS) {
+        list = &w.overflow;
+        idx = 1; // stop
+      }
+      else {
+        idx = (w.current >> (level * EVERY_WHEEL_BITS)) & SlotMask;
+        list = &w.slots[level][idx];
+      }
+
+      EveryScheduled *t = *list;
+      *list = nullptr;
+      while (t) {
+        EveryScheduled *next = t->_wheel_next;
+        _insert(*t, t->_deadline());
+        t = next;
+      }
+      return idx;
+    }
+
+    static void _rearm() {
+      // timers that t1() noticed go back in the wheel for their next interval
+      Wheel &w = wheel();
+      EveryScheduled **link = &w.due;
+      while (*link) {
+        EveryScheduled *t = *link;
+        if (t->_wheel_flags & EveryScheduled::Due) {
+          link = &t->_wheel_next; // not noticed yet
+        }
+        else {
+          *link = t->_wheel_next;
+          if (t->_wheel_flags & EveryScheduled::Periodic) _insert(*t, t->_deadline());
+          // a Timer stays out till .reset()
+        }
+      }
+    }
+
+    static boolean _unlink_from(EveryScheduled *&list, EveryScheduled &t) {
+      for (EveryScheduled **link = &list; *link; link = &(*link)->_wheel_next) {
+        if (*link == &t) {
+          *link = t._wheel_next;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    static void _unlink(EveryScheduled &t) {
+      // we don't know where it is, so this is a search. i.e. .reset() costs more when registered
+      Wheel &w = wheel();
+      if ( _unlink_from(w.due, t) || _unlink_from(w.overflow, t) ) return;
+      for (byte level = 0; level < EVERY_WHEEL_LEVELS; level++) {
+        for (unsigned int i = 0; i < Slots; i++) {
+          if ( _unlink_from(w.slots[level][i], t) ) return;
+        }
+      }
+    }
 };
+
+class Every::Interrupt {
+  // Check registered Every's from a timer interrupt, so a long blocking call in loop()
+  // (Serial flush, NeoPixel show()) doesn't delay noticing them.
+  // The interrupt only does the bookkeeping (like Every::Scheduler), and puts the expired Every on a queue.
+  // Your loop() does drain(), and then t1( []() {...} ) as usual: the lambda runs in loop(), not in the interrupt.
+  //
+  //    #define EVERY_INTERRUPT_TIMER0 // AVR: piggy-back on the millis() timer. Only in one .ino/.cpp!
+  //    #include <every.h>
+  //    static Every t1(100);
+  //    void setup() {
+  //      Every::Interrupt::add(t1); // also does the .reset()
+  //      Every::Interrupt::begin();
+  //      }
+  //    void loop() {
+  //      Every::Interrupt::drain();
+  //      t1( []() { ... } );
+  //      }
+  //
+  // Without EVERY_INTERRUPT_TIMER0 (not AVR, or you need timer0's compare-A), call Every::Interrupt::isr() from
+  // your own timer interrupt, at least every msec.
+  // The queue is single-producer (the interrupt), single-consumer (loop()), so it needs no locking.
+  // Each Every is "held" by loop() from the time it is queued till the drain() after t1() noticed it,
+  // so the interrupt never sees a half-written .interval (e.g. Every::Pattern).
+  // Up to EVERY_INTERRUPT_TIMERS Every's, and EVERY_INTERRUPT_QUEUE waiting at once (if full, it waits for the next interrupt).
+  // .last is written by the interrupt, so read it with interrupts off.
+
+  public:
+    static const byte QueueMask = EVERY_INTERRUPT_QUEUE - 1;
+    static_assert( (EVERY_INTERRUPT_QUEUE & QueueMask) == 0, "EVERY_INTERRUPT_QUEUE must be a power of 2");
+
+    struct State {
+      Every *timers[EVERY_INTERRUPT_TIMERS];
+      byte count;
+      byte first; // where isr() starts looking
+      unsigned long next; // earliest deadline, so most interrupts are one compare
+      volatile boolean rescan; // loop() re-armed something, ignore .next
+      Every * volatile queue[EVERY_INTERRUPT_QUEUE];
+      volatile byte head; // written only by the interrupt
+      volatile byte tail; // written only by loop()
+    };
+    static State &state() { static State s; return s; }
+
+    static boolean add(Every &t) {
+      State &s = state();
+      if (s.count >= EVERY_INTERRUPT_TIMERS || (t._wheel_flags & EveryScheduled::Registered)) return false;
+      t.reset();
+      EVERY_ATOMIC_BEGIN
+      t._wheel_flags = EveryScheduled::Registered | EveryScheduled::ByInterrupt;
+      s.timers[ s.count++ ] = &t;
+      s.rescan = true;
+      EVERY_ATOMIC_END
+      _arm();
+      return true;
+    }
+
+    static void remove(Every &t) {
+      State &s = state();
+      EVERY_ATOMIC_BEGIN
+      for (byte i = 0; i < s.count; i++) {
+        if (s.timers[i] == &t) {
+          s.timers[i] = s.timers[ --s.count ];
+          t._wheel_flags = 0; // a stale one in the queue will be ignored
+          break;
+        }
+      }
+      EVERY_ATOMIC_END
+    }
+
+    static void drain() {
+      // once per loop(), before any t1()
+      State &s = state();
+
+      // the ones t1() noticed since the last drain() go back to the interrupt
+      for (byte i = 0; i < s.count; i++) {
+        Every *t = s.timers[i];
+        if ( (t->_wheel_flags & (EveryScheduled::Held | EveryScheduled::Due)) == EveryScheduled::Held ) {
+          t->_wheel_flags &= ~EveryScheduled::Held; // the interrupt doesn't touch it while it's Held
+          s.rescan = true;
+          _arm();
+        }
+      }
+
+      // take from the queue
+      while (s.tail != s.head) {
+        Every *t = s.queue[ s.tail & QueueMask ];
+        s.tail++;
+        if (t->_wheel_flags & EveryScheduled::Queued) { // else: .reset() or remove()'d since
+          t->_wheel_flags = (t->_wheel_flags & ~EveryScheduled::Queued) | EveryScheduled::Due | EveryScheduled::Held;
+        }
+      }
+    }
+
+    static void isr() {
+      // in the interrupt
+      State &s = state();
+      unsigned long now = millis(); // Every::clock() may be a stale frame
+      if ( !s.rescan && (long)(now - s.next) < 0 ) return;
+      s.rescan = false;
+
+      boolean armed = false, full = false;
+      unsigned long next = now - 1; // i.e. as far as possible
+      byte i = s.first < s.count ? s.first : 0;
+      for (byte n = 0; n < s.count; n++, i = i + 1 < s.count ? i + 1 : 0) {
+        Every *t = s.timers[i];
+        if (t->_wheel_flags & (EveryScheduled::Queued | EveryScheduled::Held)) continue; // loop() has it
+
+        if ( (byte)(s.head - s.tail) < EVERY_INTERRUPT_QUEUE && t->_expire(now) ) {
+          t->_wheel_flags |= EveryScheduled::Queued;
+          s.queue[ s.head & QueueMask ] = t;
+          s.head++;
+        }
+        else {
+          unsigned long deadline = t->_deadline();
+          if ( (long)(deadline - now) <= 0 ) {
+            // queue was full, try again. Starting with this one, so the later ones don't starve
+            deadline = now + 1;
+            if (!full) s.first = i;
+            full = true;
+          }
+          if ( !armed || (long)(deadline - next) < 0 ) next = deadline;
+          armed = true;
+        }
+      }
+      s.next = next;
+      if (!armed) _disarm(); // drain() re-arms
+    }
+
+    static void _reset(Every &t) {
+      // from .reset(), with interrupts off, in the same EVERY_ATOMIC as setting .last:
+      // else the interrupt could queue a fire against the new .last, and we'd throw it away here
+      t._wheel_flags &= ~(EveryScheduled::Queued | EveryScheduled::Held | EveryScheduled::Due);
+      state().rescan = true;
+    }
+
+#if defined(EVERY_INTERRUPT_TIMER0) && defined(__AVR__)
+    // timer0 runs millis(), and its compare-A is free: so interrupt about every msec when armed.
+    static void begin() { OCR0A = 0xAF; _arm(); }
+    static void _arm() { TIMSK0 |= _BV(OCIE0A); }
+    static void _disarm() { TIMSK0 &= ~_BV(OCIE0A); }
+#else
+    static void begin() {}
+    static void _arm() {}
+    static void _disarm() {}
+#endif
+};
+
+#if defined(EVERY_INTERRUPT_TIMER0) && defined(__AVR__)
+ISR(TIMER0_COMPA_vect) { Every::Interrupt::isr(); }
+#endif
+
+inline unsigned long Every::until_next() {
+  unsigned long best = Scheduler::until_next();
+
+  Interrupt::State &is = Interrupt::state();
+  for (byte i = 0; i < is.count; i++) {
+    unsigned long left;
+    EVERY_ATOMIC_BEGIN // the interrupt writes .last
+    left = is.timers[i]->next_deadline();
+    EVERY_ATOMIC_END
+    if (left < best) best = left;
+  }
+
+  _EveryCallback *slots = _callbacks();
+  for (byte i = 0; i < EVERY_CALLBACKS; i++) {
+    // an Interrupt one was counted above (and its .last can't be read here with interrupts on)
+    if (slots[i].owner && !(slots[i].owner->_wheel_flags & ByInterrupt)) {
+      unsigned long left = slots[i].owner->next_deadline();
+      if (left < best) best = left;
+    }
+  }
+  return best;
+}
+
+inline void Every::run_all() {
+  // once per loop(): turn the Scheduler, drain the Interrupt queue, and call the .on()'s that fired.
+  Scheduler::run();
+  Interrupt::drain();
+
+  _EveryCallback *slots = _callbacks();
+  for (byte i = 0; i < EVERY_CALLBACKS; i++) {
+    Every *t = slots[i].owner;
+    if (t && (*t)()) slots[i].call(slots[i].store);
+  }
+}
+
+inline void Every::reset(boolean now) {
+  if (_wheel_flags & ByInterrupt) {
+    EVERY_ATOMIC_BEGIN // the interrupt reads .last
+    last = Every::clock();
+    if (now) last -= interval;
+    Interrupt::_reset(*this);
+    EVERY_ATOMIC_END
+    Interrupt::_arm();
+  }
+  else {
+    last = Every::clock();
+    if (now) last -= interval;
+    if (_wheel_flags & Registered) Scheduler::_reschedule(*this);
+  }
+}
+
+#ifdef SPARK_PLATFORM
+inline void Every::Timer::reset() {
+#else
+inline void Timer::reset() {
+#endif
+  running = true;
+  last = Every::clock();
+  if (_wheel_flags & Registered) Every::Scheduler::_reschedule(*this);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+  Just enough Arduino to compile the header-only stuff with g++ on the host.
+  Not a simulator: the clock only moves when a test sets it.
+
+    mock_ms = 1000; // what millis() says. mock_us for micros()
+    mock_clock_reads // counts millis()/micros() calls
+    mock_adc // what analogRead() says
+    mock_pin[pin] // what digitalRead() says, digitalWrite() sets it
+    mock_analog[pin] // the last analogWrite()
+    mock_io_trace = 1; // print digitalWrite()/analogWrite()'s
+
+  The Makefile -include's this, like the IDE does for a .ino.
+  Note that a long is 64 bits here, so millis() rolls over at 2^64 (same logic, later).
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdio.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define A0 14
+#define A5 19
+#define LED_BUILTIN 13
+#define HEX 16
+#define DEC 10
+#define BIN 2
+
+// no flash, PROGMEM is plain memory
+#define PROGMEM
+#define F(x) x
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_ptr(p) (*(void * const*)(p))
+#define memcpy_P memcpy
+
+// no interrupts either. A test that wants an "ISR" calls it
+#define noInterrupts()
+#define interrupts()
+
+extern unsigned long mock_ms, mock_us, mock_clock_reads;
+inline unsigned long millis() { mock_clock_reads++; return mock_ms; }
+inline unsigned long micros() { mock_clock_reads++; return mock_us; }
+inline void delay(unsigned long) {}
+
+extern int mock_io_trace, mock_adc;
+extern byte mock_pin[64];
+extern int mock_analog[64];
+inline void pinMode(int, int) {}
+inline void digitalWrite(int pin, int v) {
+  mock_pin[pin & 63] = v;
+  if (mock_io_trace) printf("digitalWrite %d %d\n", pin, v);
+  }
+inline int digitalRead(int pin) { return mock_pin[pin & 63]; }
+inline void analogWrite(int pin, int v) {
+  mock_analog[pin & 63] = v;
+  if (mock_io_trace) printf("analogWrite %d %d\n", pin, v);
+  }
+inline int analogRead(int) { return mock_adc; }
+inline long random(long max) { return max ? rand() % max : 0; }
+inline long random(long min, long max) { return min + random(max - min); }
+
+struct Print {
+  // to stdout
+  size_t write(uint8_t b) { return putchar(b) == EOF ? 0 : 1; }
+  size_t write(const uint8_t *buf, size_t n) { return fwrite(buf, 1, n, stdout); }
+  int availableForWrite() { return 63; } // never blocks
+  void begin(long) {}
+  void flush() { fflush(stdout); }
+  operator bool() { return true; }
+
+  size_t print(const char *s) { return printf("%s", s); }
+  size_t print(char c) { return printf("%c", c); }
+  size_t print(unsigned long v, int base = DEC) { return printf(base == HEX ? "%lX" : "%lu", v); }
+  size_t print(long v, int base = DEC) { return base == HEX ? printf("%lX", v) : printf("%ld", v); }
+  size_t print(unsigned int v, int base = DEC) { return print( (unsigned long) v, base); }
+  size_t print(int v, int base = DEC) { return print( (long) v, base); }
+  size_t print(unsigned short v, int base = DEC) { return print( (unsigned long) v, base); }
+  size_t print(short v, int base = DEC) { return print( (long) v, base); }
+  size_t print(unsigned char v, int base = DEC) { return print( (unsigned long) v, base); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(T v, int base) { size_t n = print(v, base); return n + println(); }
+  size_t println() { return printf("\n"); }
+  };
+typedef Print HardwareSerial;
+extern HardwareSerial Serial;
@@ -0,0 +1,24 @@
+// AutoBilevelBank of 16 sensors, ns per sensor-sample
+
+#include "auto_bilevel.h"
+#include "host_test.h"
+#include "auto_bilevel_trace.h"
+
+const int Sensors = 16, Recorded = 4096, Reps = 250;
+int raw[Recorded][Sensors];
+
+int main() {
+  srand(2);
+  for (int i = 0; i < Recorded; i++) for (int k = 0; k < Sensors; k++) raw[i][k] = trace_sample(i, k, 15);
+
+  AutoBilevelBank<int, 2, 5, Sensors> bank(50);
+  long changes = 0;
+  double start = host_ns();
+  for (int rep = 0; rep < Reps; rep++) for (int i = 0; i < Recorded; i++) changes += bank.update(raw[i]);
+  double ns = (host_ns() - start) / ( (double) Reps * Recorded * Sensors );
+  keep(changes);
+  CHECK( changes > 0 );
+
+  printf("AutoBilevelBank<int, 2, 5, %d>\t%.2f ns per sensor-sample\tsizeof AutoBilevel<int, 2, 5> %d\n",
+    Sensors, ns, (int) sizeof(AutoBilevel<int, 2, 5>));
+  }
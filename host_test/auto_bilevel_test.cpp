@@ -0,0 +1,59 @@
+// Replay a noisy trace through auto_bilevel_graph() (float, one sensor) and AutoBilevel (integer), and a bank of them
+
+#define TELEMETRY_TX 128 // so auto_bilevel_graph() doesn't print a line per sample, the records just fill the ring
+#include "auto_bilevel.h"
+#include "host_test.h"
+#include "auto_bilevel_trace.h"
+
+const long Samples = 200000;
+const int Noise = 15;
+
+int main() {
+  srand(2);
+
+  // factors 4 and 32, same as shifts 2 and 5
+  AutoBilevel<int, 2, 5> touch(50);
+  long disagree_graph = 0, disagree_int = 0, changes = 0, touches = 0, caught = 0, late = 0;
+  boolean caught_this = false;
+  for (long i = 0; i < Samples; i++) {
+    const int raw = trace_sample(i, 0, Noise);
+    const boolean graph = auto_bilevel_graph(raw, 4, 32, 50);
+    const boolean old_int = auto_bilevel(raw, 4, 32, 50);
+    changes += touch.update(raw);
+    disagree_graph += graph != touch.on();
+    disagree_int += old_int != touch.on();
+
+    // each touch is seen, soon enough
+    if (trace_touching(i, 0) && !trace_touching(i - 1, 0)) { touches++; caught_this = false; }
+    if (trace_touching(i, 0) && touch.on() && !caught_this) {
+      caught_this = true;
+      caught++;
+      if (i % 800 - 500 > 10) late++;
+      }
+    }
+  printf("%ld samples, %ld touches, %ld caught (%ld late), %ld changes. Disagreements: float auto_bilevel_graph %ld, int auto_bilevel %ld\n",
+    Samples, touches, caught, late, changes, disagree_graph, disagree_int);
+  CHECK( caught == touches && late == 0 );
+  CHECK( changes == 2 * touches ); // on and off, no chatter
+  CHECK( disagree_graph < Samples / 1000 ); // rounding, near the thresholds
+  CHECK( Telemetry::state().dropped > 0 ); // i.e. auto_bilevel_graph() really ran
+
+  // a bank is the same as each by itself
+  const int Sensors = 16;
+  AutoBilevelBank<int, 2, 5, Sensors> bank(50);
+  AutoBilevel<int, 2, 5> alone[Sensors];
+  for (int k = 0; k < Sensors; k++) alone[k].significant = 50;
+  long bank_changes = 0;
+  for (long i = 0; i < 20000; i++) {
+    int raw[Sensors];
+    for (int k = 0; k < Sensors; k++) raw[k] = trace_sample(i, k, Noise);
+    bank_changes += bank.update(raw);
+    for (int k = 0; k < Sensors; k++) {
+      alone[k].update(raw[k]);
+      CHECK( bank[k].on() == alone[k].on() );
+      CHECK( bank[k].fast.value() == alone[k].fast.value() && bank[k].slow.value() == alone[k].slow.value() );
+      }
+    }
+  printf("bank of %d: %ld changes, same as each alone\n", Sensors, bank_changes);
+  CHECK( bank_changes >= Sensors * 2 * (20000 / 800 - 1) ); // less ones cut off at the start/end
+  }
@@ -0,0 +1,16 @@
+#pragma once
+
+// A made up cap-touch trace, for auto_bilevel_test and auto_bilevel_bench.
+// Floor about 20 (+ k), drifting by +-40, gaussian noise, and a touch (+600) for 200 of every 800 samples.
+// Sensor k's touches are 97 samples later than k-1's.
+
+inline double trace_gauss() {
+  double u = (rand() + 1.0) / (RAND_MAX + 2.0), v = (rand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+  }
+
+inline boolean trace_touching(long i, int k) { return (i + k * 97) % 800 >= 500 && (i + k * 97) % 800 < 700; }
+
+inline int trace_sample(long i, int k, double noise) {
+  return (int) lround( 20 + k + 40 * sin(i / 3000.0) + (trace_touching(i, k) ? 600 : 0) + noise * trace_gauss() );
+  }
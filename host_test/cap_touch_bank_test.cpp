@@ -0,0 +1,108 @@
+// CapTouchBank<12> with a simulated ADC (conversions take a few polls), 2M run()'s,
+// against 12 CapTouchCrossover-style CrossOverDetect's fed the same readings: same state, same touched()/released().
+// The pads get touched (the reading drops) at random, with noise.
+
+#include "CapTouchCrossover.h"
+#include "host_test.h"
+
+const byte N = 12;
+const byte Ref = A5;
+const unsigned long Passes = 2000000;
+const byte pads[N] = { 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, A0 };
+
+unsigned long now; // run()'s so far: the simulation's clock
+
+// the pads: a baseline, minus 80 while touched, plus noise
+struct Pad {
+  boolean touched;
+  unsigned long until; // next change
+  unsigned long touches;
+  } pad[N];
+
+int reading(byte pin) {
+  if (pin == Ref) return 50 + rand() % 7 - 3;
+  for (byte i = 0; i < N; i++) {
+    if (pads[i] != pin) continue;
+    Pad &p = pad[i];
+    if (now >= p.until) {
+      p.touched = !p.touched;
+      p.touches += p.touched;
+      p.until = now + 20000 + rand() % 100000;
+      }
+    return 300 + 20 * i - (p.touched ? 80 : 0) + rand() % 11 - 5;
+    }
+  CHECK( !"a pin we don't have" );
+  return 0;
+  }
+
+struct SimAdc {
+  // a conversion is busy for 0..3 polls. Remembers the last 2 results, so we can check what the bank got
+  static byte pin, polls;
+  static int last[2];
+  static byte last_pin[2];
+  static void start(byte p) { pin = p; polls = rand() % 4; }
+  static boolean busy() { return polls && polls--; }
+  static int result() {
+    last[0] = last[1]; last_pin[0] = last_pin[1];
+    last[1] = reading(pin); last_pin[1] = pin;
+    return last[1];
+    }
+  };
+byte SimAdc::pin, SimAdc::polls, SimAdc::last_pin[2];
+int SimAdc::last[2];
+
+typedef CrossOverDetect< ExponentialSmooth<int> > Detect;
+
+int main() {
+  srand(7);
+  for (byte i = 0; i < N; i++) pad[i].until = rand() % 50000;
+
+  CapTouchBank<N, SimAdc> bank(pads, 20, 50, 10, Ref);
+  // CapTouchCrossover's: v1 is the slow one, v2 the fast
+  ExponentialSmooth<int> slow[N], fast[N];
+  Detect *expect[N];
+  for (byte i = 0; i < N; i++) {
+    slow[i].set_factor(50);
+    fast[i].set_factor(20);
+    expect[i] = new Detect(10, &slow[i], &fast[i], -1);
+    }
+
+  bank.setup();
+  for (byte i = 0; i < N; i++) {
+    slow[i].reset(bank.raw[i]);
+    fast[i].reset(bank.raw[i]);
+    }
+
+  unsigned long updates = 0, rounds = 0, touches = 0, releases = 0;
+  for (now = 0; now < Passes; now++) {
+    byte i = bank.current;
+    boolean on_ref = bank.on_ref;
+    rounds += bank.run();
+    if (bank.current == i) continue; // still converting, or just read the pin and started the ref
+
+    // pad i finished: the last 2 results were its pin and the ref
+    CHECK( on_ref && !bank.on_ref );
+    CHECK( SimAdc::last_pin[0] == pads[i] && SimAdc::last_pin[1] == Ref );
+    int v = SimAdc::last[0] - SimAdc::last[1];
+    CHECK( bank.raw[i] == v );
+    slow[i].average(v);
+    fast[i].average(v);
+    updates++;
+
+    CHECK( bank.state[i] == expect[i]->state() );
+    boolean t = bank.touched(i), r = bank.released(i);
+    CHECK( t == expect[i]->d_on() );
+    CHECK( r == expect[i]->d_off() );
+    touches += t;
+    releases += r;
+    CHECK( bank.slow.value(i) == slow[i].value() && bank.fast.value(i) == fast[i].value() );
+    }
+
+  unsigned long simulated = 0;
+  for (byte i = 0; i < N; i++) simulated += pad[i].touches;
+  printf("%lu passes, %lu readings, %lu rounds of %d, touches %lu (simulated %lu), releases %lu\n",
+    Passes, updates, rounds, N, touches, simulated, releases);
+  CHECK( rounds == updates / N );
+  // and it does find the touches (the last might be too recent)
+  CHECK( touches > 0 && touches + N >= simulated && touches <= simulated );
+  }
@@ -0,0 +1,90 @@
+// CapTouchCalibration on fixed traces: what it works out (noise, amplitude, fast/slow/delta),
+// and that a CapTouchCrossover with those (instead of a bad guess) sees each touch once, and nothing else.
+
+#include "CapTouchCrossover.h"
+#include "host_test.h"
+
+// a pad: 500, 150 lower while touched (300 of every 1500 samples, from 1000), plus a fixed noise pattern
+const int Period = 1500, TouchAt = 1000, TouchFor = 300, Depth = 150;
+const int noise_pattern[] = { 0, 6, -3, 4, -7, 2, -5, 3 };
+const int Patterns = sizeof(noise_pattern) / sizeof(noise_pattern[0]); // average |noise| 3.75
+boolean touch_at(long i) { return i % Period >= TouchAt && i % Period < TouchAt + TouchFor; }
+int pad(long i, boolean touches = true) { return 500 - (touches && touch_at(i) ? Depth : 0) + noise_pattern[i % Patterns]; }
+
+struct NoAdc { static void start(byte) {} static boolean busy() { return false; } static int result() { return 0; } };
+
+// what propose() says fast should be, for that noise & delta
+int fast_for(int noise, int delta) {
+  long ratio = (25L * noise * noise + (long) delta * delta - 1) / ((long) delta * delta);
+  int fast = (ratio + 2) / 2;
+  return fast < 4 ? 4 : fast;
+  }
+
+int main() {
+  // nothing going on: the minimums
+  CapTouchCalibration quiet(500);
+  for (int i = 0; i < 499; i++) CHECK( !quiet.sample(300) );
+  CHECK( quiet.sample(300) );
+  CHECK( quiet.noise == 1 && quiet.amplitude == 0 && !quiet.saw_touch );
+  CHECK( quiet.delta == 3 && quiet.fast == 4 && quiet.slow == 10 );
+
+  // a bad guess: delta too big to ever cross
+  CapTouchCrossover touch(A0, 5, 10, 400);
+  touch.crossover.v1.reset( touch.crossover.v2.reset(pad(0)) );
+  CapTouchCalibration calibrate(2 * Period);
+  calibrate.apply(touch); // no window yet, so nothing
+  CHECK( touch.crossover.delta == 400 && touch.crossover.v1.factor() == 10 && touch.crossover.v2.factor() == 5 );
+
+  long i = 0;
+  for (; i < 2 * Period - 1; i++) {
+    touch.crossover.v1.average(pad(i)); touch.crossover.v2.average(pad(i));
+    CHECK( !touch.touched() );
+    CHECK( !calibrate.sample(pad(i)) );
+    }
+  CHECK( calibrate.sample(pad(i++)) );
+  printf("noise %d amplitude %d %s fast %d slow %d delta %d\n",
+    calibrate.noise, calibrate.amplitude, calibrate.saw_touch ? "touched" : "no touch", calibrate.fast, calibrate.slow, calibrate.delta);
+  CHECK( calibrate.noise >= 3 && calibrate.noise <= 6 ); // about the pattern's 3.75, quick lags a bit
+  CHECK( calibrate.saw_touch );
+  CHECK( calibrate.amplitude > Depth - 20 && calibrate.amplitude <= Depth ); // less the noise allowance
+  CHECK( calibrate.delta == calibrate.amplitude / 4 );
+  CHECK( calibrate.fast == fast_for(calibrate.noise, calibrate.delta) );
+  CHECK( calibrate.slow == calibrate.fast * 5 / 2 );
+
+  calibrate.apply(touch);
+  CHECK( touch.crossover.delta == calibrate.delta );
+  CHECK( touch.crossover.v1.factor() == calibrate.slow && touch.crossover.v2.factor() == calibrate.fast );
+  const byte pins[2] = { A0, A0 + 1 };
+  CapTouchBank<2, NoAdc> bank(pins, 5, 10, 400);
+  calibrate.apply(bank);
+  CHECK( bank.delta == calibrate.delta && bank.slow.factor() == calibrate.slow && bank.fast.factor() == calibrate.fast );
+
+  // now each touch is seen once: touched() during it, released() during it or soon after. Nothing in between
+  int touches = 0, releases = 0;
+  long touched_at = -1;
+  const long End = i + 6 * Period;
+  for (; i < End; i++) {
+    touch.crossover.v1.average(pad(i)); touch.crossover.v2.average(pad(i));
+    if (touch.touched()) {
+      CHECK( touch_at(i) );
+      touched_at = i;
+      touches++;
+      }
+    if (touch.released()) {
+      CHECK( touched_at >= 0 && i - touched_at < Period - TouchFor ); // before the next touch
+      releases++;
+      touched_at = -1;
+      }
+    calibrate.sample(pad(i));
+    }
+  printf("%d touches, %d releases\n", touches, releases);
+  CHECK( touches == 6 && releases == 6 );
+
+  // a window with no touches: delta stays, the noise is still measured
+  int delta = calibrate.delta;
+  while ( !calibrate.sample(pad(i++, false)) ) {}
+  while ( !calibrate.sample(pad(i++, false)) ) {} // (the first one had the end of a touch in it)
+  CHECK( !calibrate.saw_touch );
+  CHECK( calibrate.delta == delta );
+  CHECK( calibrate.noise >= 3 && calibrate.noise <= 6 );
+  }
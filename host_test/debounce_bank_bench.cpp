@@ -0,0 +1,44 @@
+// 64 buttons: one DebounceBank<uint64_t> vs 64 Debounce's, ns per sample of all of them
+
+#include "debounce.h"
+#include "host_test.h"
+
+const int Samples = 1000000;
+uint64_t snapshots[4096]; // noisy-ish port reads
+
+int main() {
+  srand(8);
+  uint64_t raw = 0;
+  for (int i = 0; i < 4096; i++) {
+    if (rand() % 4 == 0) raw ^= 1ULL << (rand() % 64);
+    snapshots[i] = raw;
+    }
+
+  DebounceBank<uint64_t> bank;
+  uint64_t sum = 0;
+  double start = host_ns();
+  for (int s = 0; s < Samples; s++) {
+    mock_ms = s;
+    sum += bank( snapshots[s & 4095] );
+    }
+  double bank_ns = (host_ns() - start) / Samples;
+  keep(sum);
+
+  Debounce *buttons[64];
+  for (int b = 0; b < 64; b++) buttons[b] = new Debounce(LOW, 4);
+  sum = 0;
+  start = host_ns();
+  for (int s = 0; s < Samples; s++) {
+    mock_ms = s;
+    uint64_t raw = snapshots[s & 4095], debounced = 0;
+    for (int b = 0; b < 64; b++) debounced |= (uint64_t) (*buttons[b])( (raw >> b) & 1 ) << b;
+    sum += debounced;
+    }
+  double each_ns = (host_ns() - start) / Samples;
+  keep(sum);
+
+  printf("ns per sample of 64 buttons\n");
+  printf("  DebounceBank<uint64_t>\t%.1f\n", bank_ns);
+  printf("  64 Debounce\t%.1f\n", each_ns);
+  printf("sizeof DebounceBank<uint64_t> %zu, 64 Debounce %zu\n", sizeof(bank), 64 * sizeof(Debounce));
+  }
@@ -0,0 +1,60 @@
+// DebounceBank<T> vs a bit-at-a-time model of it: flip after 4 disagreeing samples in a row
+
+#include "debounce.h"
+#include "host_test.h"
+
+template <typename T>
+void check(unsigned long samples) {
+  const int Bits = 8 * sizeof(T);
+  DebounceBank<T> bank;
+  byte count[64] = {0};
+  boolean model[64] = {0};
+  T raw = 0;
+  T model_pressed = 0, model_released = 0; // since the last take
+  unsigned long presses = 0, releases = 0;
+
+  for (unsigned long s = 0; s < samples; s++) {
+    // each bit: sometimes a real change, sometimes a 1-3 sample glitch
+    for (int b = 0; b < Bits; b++) {
+      if (rand() % 16 == 0) raw ^= (T) 1 << b;
+      }
+    T toggled = bank.update(raw);
+
+    T expect = 0;
+    for (int b = 0; b < Bits; b++) {
+      boolean bit = (raw >> b) & 1;
+      if (bit == model[b]) count[b] = 0;
+      else if (++count[b] == 4) {
+        count[b] = 0;
+        model[b] = bit;
+        if (bit) { model_pressed |= (T) 1 << b; presses++; }
+        else { model_released |= (T) 1 << b; releases++; }
+        CHECK( (toggled >> b) & 1 );
+        }
+      if (model[b]) expect |= (T) 1 << b;
+      }
+    CHECK( bank.debounced == expect );
+
+    if (rand() % 8 == 0) {
+      CHECK( bank.take_pressed() == model_pressed );
+      CHECK( bank.take_released() == model_released );
+      CHECK( bank.pressed == 0 && bank.released == 0 );
+      model_pressed = model_released = 0;
+      }
+    }
+  printf("%d bits: %lu presses, %lu releases\n", Bits, presses, releases);
+  }
+
+int main() {
+  srand(8);
+  check<uint8_t>(200000);
+  check<uint16_t>(100000);
+  check<uint32_t>(50000);
+  check<uint64_t>(50000);
+
+  // a steady bit never flips, no matter the glitches shorter than 4
+  DebounceBank<uint8_t> steady(0x0F);
+  for (int i = 0; i < 1000; i++) {
+    CHECK( steady( i % 4 == 3 ? 0x0F : 0xF0 ) == 0x0F );
+    }
+  }
@@ -0,0 +1,52 @@
+// The compile-time debouncers (DebounceOf<> etc.) vs the classes they replace, and DebounceShift<n>
+
+#include "debounce.h"
+#include "host_test.h"
+
+// What they cost, vs the runtime ones
+static_assert( sizeof(DebounceAsymmetricOf<100, 10>) == 2, "" );
+static_assert( sizeof(DebounceOf<25>) == 2, "" );
+static_assert( sizeof(DebounceLowOf<7>) == 2, "" );
+static_assert( sizeof(DebounceShift<4>) == 1, "" );
+
+int main() {
+  printf("sizeof Debounce %zu, DebounceOf<> %zu; DebounceHigh %zu, DebounceHighOf<> %zu; DebounceShift<> %zu\n",
+    sizeof(Debounce), sizeof(DebounceOf<25>), sizeof(DebounceHigh), sizeof(DebounceHighOf<30>), sizeof(DebounceShift<4>)
+    );
+
+  srand(4);
+  DebounceAsymmetric a(true, 100, 10); DebounceAsymmetricOf<100, 10> b(true);
+  Debounce c(25); DebounceOf<25> d;
+  DebounceHigh e(30); DebounceHighOf<30> f;
+  DebounceLow g(7); DebounceLowOf<7> h;
+  boolean raw = HIGH;
+  unsigned long t = 1;
+  // a noisy signal, polled every 0..2 msec, sometimes not for up to 16 sec (the packed stamp is 14 bits)
+  for (long i = 0; i < 3000000; i++) {
+    t += rand() % 50 == 0 ? rand() % 16000 : rand() % 3;
+    mock_ms = t;
+    if (rand() % 4 == 0) raw = !raw;
+    CHECK( a(raw) == b(raw) );
+    CHECK( c(raw) == d(raw) );
+    CHECK( e(raw) == f(raw) );
+    CHECK( g(raw) == h(raw) );
+    CHECK( a.next_deadline() == b.next_deadline() );
+    CHECK( c.next_deadline() == d.next_deadline() );
+    CHECK( e.next_deadline() == f.next_deadline() );
+    CHECK( g.next_deadline() == h.next_deadline() );
+    }
+
+  // DebounceShift<n> changes when the last n samples agree
+  DebounceShift<3> shift(LOW);
+  boolean debounced = LOW;
+  byte run = 0;
+  boolean prev = LOW;
+  for (long i = 0; i < 1000000; i++) {
+    if (rand() % 3 == 0) raw = !raw;
+    run = raw != prev ? 1 : run < 3 ? run + 1 : 3;
+    prev = raw;
+    if (run >= 3) debounced = raw;
+    CHECK( shift(raw) == debounced );
+    }
+  puts("ok");
+  }
@@ -0,0 +1,31 @@
+#pragma once
+
+// for every_clock_reads_test.cpp and every_frame_clock_test.cpp: the same loop(), with and without EVERY_FRAME_CLOCK
+
+#include "every.h"
+#include "host_test.h"
+
+Every a(10), b(20);
+Timer t(100);
+EveryMicros m(5000);
+Every::Pattern p;
+
+const int Passes = 1000;
+
+// millis()+micros() calls per loop() pass, and how many fired
+double clock_reads_per_pass(unsigned long &fired) {
+  mock_ms = 0; mock_us = 0;
+  Every::tick(); EveryMicros::tick();
+  a.reset(); b.reset(); t.reset(); m.reset(); p.reset();
+
+  fired = 0;
+  unsigned long before = mock_clock_reads;
+  for (int i = 1; i <= Passes; i++) {
+    mock_ms = i; mock_us = i * 1000UL;
+    Every::tick(); EveryMicros::tick(); // nothing without EVERY_FRAME_CLOCK
+    fired += a() + b() + t() + m() + p();
+    }
+  return double(mock_clock_reads - before) / Passes;
+  }
+
+const unsigned long Fired = 100 + 50 + 1 + 200 + 3; // either way
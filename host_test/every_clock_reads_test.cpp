@@ -0,0 +1,11 @@
+// Without EVERY_FRAME_CLOCK, each timer reads the clock. See every_frame_clock_test.cpp
+
+#include "every_clock_reads.h"
+
+int main() {
+  unsigned long fired;
+  double reads = clock_reads_per_pass(fired);
+  printf("%.2f clock reads per pass, %lu fired\n", reads, fired);
+  CHECK( reads > 4 ); // one per timer, but a finished Timer doesn't look
+  CHECK( fired == Fired );
+  }
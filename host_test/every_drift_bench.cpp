@@ -0,0 +1,63 @@
+// The drift correction (how late a timer is) in each flavor, cycles per call.
+// On the AVR, % is a 32 bit software division. On x86 it's a hardware divide, so the spread is smaller.
+
+#include "every.h"
+#include "host_test.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+inline unsigned long long cycles() { return __rdtsc(); }
+const char *Unit = "cycles";
+#else
+inline unsigned long long cycles() { return host_ns(); }
+const char *Unit = "ns";
+#endif
+
+const int N = 4096;
+const int Rounds = 2000;
+unsigned long diffs[N];
+volatile unsigned long interval_100 = 100, interval_128 = 128; // so the runtime ones stay runtime
+
+// like diffs for a timer polled every msec or so: mostly within 1 interval of expiring, sometimes late
+void make_diffs(unsigned long interval) {
+  srand(1);
+  for (int i = 0; i < N; i++) {
+    diffs[i] = interval + (rand() % 8 == 0 ? rand() % (5 * interval) : rand() % 3);
+    }
+  }
+
+unsigned long modulo(unsigned long diff, unsigned long interval) { return diff % interval; } // what Every did
+unsigned long mask(unsigned long diff, unsigned long interval) { return diff & (interval - 1); } // EVERY_POW2_INTERVALS
+
+template <typename F>
+double run(F f, unsigned long &sum) {
+  sum = 0;
+  unsigned long long start = cycles();
+  for (int r = 0; r < Rounds; r++) {
+    for (int i = 0; i < N; i++) sum += f(diffs[i]);
+    keep(sum);
+    }
+  return double(cycles() - start) / (double(Rounds) * N);
+  }
+
+int main() {
+  unsigned long expect, sum;
+  printf("%s per drift correction\n", Unit);
+
+  make_diffs(100);
+  printf("interval 100\n");
+  printf("  diff %% interval\t%.2f\n", run([](unsigned long d) { return modulo(d, interval_100); }, expect));
+  printf("  Every (subtract)\t%.2f\n", run([](unsigned long d) { return Every::_drift(d, interval_100); }, sum));
+  CHECK( sum == expect );
+  printf("  Every::Fixed<100>\t%.2f\n", run([](unsigned long d) { return Every::Fixed<100>::_fixed_drift(d); }, sum));
+  CHECK( sum == expect );
+
+  make_diffs(128);
+  printf("interval 128\n");
+  printf("  diff %% interval\t%.2f\n", run([](unsigned long d) { return modulo(d, interval_128); }, expect));
+  printf("  Every (subtract)\t%.2f\n", run([](unsigned long d) { return Every::_drift(d, interval_128); }, sum));
+  CHECK( sum == expect );
+  printf("  EVERY_POW2_INTERVALS\t%.2f\n", run([](unsigned long d) { return mask(d, interval_128); }, sum));
+  CHECK( sum == expect );
+  printf("  Every::Fixed<128>\t%.2f\n", run([](unsigned long d) { return Every::Fixed<128>::_fixed_drift(d); }, sum));
+  CHECK( sum == expect );
+  }
@@ -0,0 +1,26 @@
+// Every::Fixed<N> (registered or not) fires exactly when Every(N) does
+
+#include "every.h"
+#include "host_test.h"
+
+int main() {
+  srand(3);
+  Every a(100), c(128);
+  Every::Fixed<100> b, e;
+  Every::Fixed<128> d;
+  Every::Scheduler::add(e);
+
+  unsigned long fired = 0;
+  // mostly every msec, sometimes very late
+  for (unsigned long t = 0; t < 500000; t += 1 + (rand() % 5 == 0 ? rand() % 400 : 0)) {
+    mock_ms = t;
+    Every::Scheduler::run();
+    boolean x = a();
+    CHECK( x == b() );
+    CHECK( x == e() );
+    CHECK( c() == d() );
+    fired += x;
+    }
+  CHECK( fired > 0 );
+  printf("ok, %lu fired\n", fired);
+  }
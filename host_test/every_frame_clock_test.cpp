@@ -0,0 +1,23 @@
+// With EVERY_FRAME_CLOCK, only the tick()'s read the clock. See every_clock_reads_test.cpp
+
+#define EVERY_FRAME_CLOCK
+#include "every_clock_reads.h"
+
+int main() {
+  unsigned long fired;
+  double reads = clock_reads_per_pass(fired);
+  printf("%.2f clock reads per pass, %lu fired\n", reads, fired);
+  CHECK( reads == 2 ); // Every::tick() and EveryMicros::tick()
+  CHECK( fired == Fired );
+
+  // the clock doesn't move between tick()'s, so timers reset together fire together
+  Every x(7), y(7);
+  Every::tick(); x.reset(); y.reset();
+  for (int i = 0; i < 1000; i++) {
+    mock_ms += 3;
+    Every::tick();
+    boolean fx = x();
+    mock_ms++; // time passes during the pass
+    CHECK( fx == y() );
+    }
+  }
@@ -0,0 +1,107 @@
+// Every::Interrupt's queue with the "interrupt" on another thread, so loop() and isr() really overlap.
+// The isr() thread is also the clock (like timer0 and millis()).
+// noInterrupts() is a mutex that isr() holds, so those sections stay atomic like on the chip.
+// The queue itself takes no lock, that's what's stressed: it's smaller than the timer count, so it fills.
+// On one cpu, the threads take turns at random points, which is still the interleaving we want.
+
+#include <mutex>
+#include <thread>
+#include <atomic>
+std::mutex irq;
+#undef noInterrupts
+#undef interrupts
+#define noInterrupts() irq.lock()
+#define interrupts() (irq.unlock(), std::this_thread::yield()) // and let the isr() in, right there
+
+#define EVERY_INTERRUPT_QUEUE 4
+#define EVERY_INTERRUPT_TIMERS 9
+#include "every.h"
+#include "host_test.h"
+
+const unsigned long Ticks = 200000; // msec
+const int N = 7;
+Every timers[N];
+const unsigned long intervals[N] = { 1, 2, 3, 5, 7, 11, 13 };
+Every::Pattern heartbeat;
+// reset(true)'s now and then: must fire at once, not get lost to an isr() in the middle of the reset()
+Every kick(5000);
+boolean kicking = false;
+unsigned long kicked_at, kicks, kicked, worst_kick;
+
+std::atomic<boolean> done(false);
+
+void interrupt() {
+  for (unsigned long ms = 1; ms <= Ticks; ms++) {
+    std::lock_guard<std::mutex> lock(irq);
+    mock_ms = ms;
+    Every::Interrupt::isr();
+    if (ms % 16 == 0) std::this_thread::yield(); // else one core mostly runs just us
+    }
+  done = true;
+  }
+
+unsigned long start_last[N], prev_last[N], fired[N], heartbeats;
+
+void loop_pass() {
+  Every::Interrupt::drain();
+  for (int i = 0; i < N; i++) {
+    if ( timers[i]() ) {
+      // we hold it till the next drain(), so .last is ours to read
+      unsigned long last = timers[i].last;
+      CHECK( last > prev_last[i] ); // not twice for one expiry
+      CHECK( (last - start_last[i]) % intervals[i] == 0 ); // the isr() drift correction kept the phase
+      prev_last[i] = last;
+      fired[i]++;
+      }
+    }
+  heartbeats += heartbeat( [](){} );
+  if (kick() && kicking) {
+    irq.lock(); unsigned long late = mock_ms - kicked_at; irq.unlock();
+    if (late > worst_kick) worst_kick = late;
+    kicking = false;
+    kicked++;
+    }
+  }
+
+int main() {
+  mock_ms = 0;
+  for (int i = 0; i < N; i++) {
+    timers[i].interval = intervals[i];
+    CHECK( Every::Interrupt::add(timers[i]) );
+    start_last[i] = prev_last[i] = timers[i].last;
+    }
+  CHECK( Every::Interrupt::add(heartbeat) );
+  CHECK( Every::Interrupt::add(kick) );
+
+  std::thread isr(interrupt);
+  unsigned long passes = 0;
+  while (!done) {
+    loop_pass();
+    if (++passes % 64 == 0) std::this_thread::yield();
+    if (!kicking && passes % 500 == 0) {
+      irq.lock(); kicked_at = mock_ms; irq.unlock();
+      kick.reset(true);
+      kicking = true;
+      kicks++;
+      }
+    if (passes % 1000 == 0) {
+      // a long blocking call, e.g. a NeoPixel show()
+      volatile int spin = 0; while (spin < 20000) spin++;
+      }
+    }
+  isr.join();
+
+  // the last expiries: the drain()'s give them back, the isr()'s queue them. A round per timer, the queue is smaller
+  for (int i = 0; i < EVERY_INTERRUPT_TIMERS; i++) { Every::Interrupt::isr(); loop_pass(); }
+  for (int i = 0; i < N; i++) {
+    printf("interval %lu: fired %lu of %lu\n", intervals[i], fired[i], Ticks / intervals[i]);
+    CHECK( fired[i] <= Ticks / intervals[i] );
+    CHECK( fired[i] * 2 > fired[0] ); // the full queue doesn't starve the later ones
+    CHECK( Ticks - prev_last[i] < intervals[i] ); // none got stuck
+    }
+
+  printf("heartbeats %lu, loop passes %lu, reset(true)'s %lu fired %lu, worst %lu msec late\n", heartbeats, passes, kicks, kicked, worst_kick);
+  CHECK( heartbeats > 0 );
+  CHECK( kicks > 10 && kicked >= kicks - 1 ); // the last one might still be waiting
+  CHECK( worst_kick < 2500 ); // a lost one waits the whole 5000
+  }
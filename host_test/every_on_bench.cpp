@@ -0,0 +1,59 @@
+// Every::on() + Every::run_all() vs the hand-written if chain, per loop() pass.
+// 8 timers with small callbacks, one pass per simulated msec. Also checks both call the same callbacks.
+
+#include "every.h"
+#include "host_test.h"
+
+const unsigned long Passes = 2000000;
+const int N = 8;
+const unsigned long intervals[N] = { 10, 15, 20, 50, 100, 250, 500, 1000 };
+unsigned long counts[N];
+
+Every a[N], b[N];
+
+template <typename F>
+double per_pass(F pass) {
+  memset(counts, 0, sizeof(counts));
+  mock_ms = 0;
+  double start = host_ns();
+  for (unsigned long ms = 1; ms <= Passes; ms++) {
+    mock_ms = ms;
+    pass();
+    }
+  return (host_ns() - start) / Passes;
+  }
+
+int main() {
+  for (int i = 0; i < N; i++) { a[i].interval = intervals[i]; b[i].interval = intervals[i]; }
+
+  for (int i = 0; i < N; i++) a[i].reset();
+  double chain = per_pass( []() {
+    if (a[0]()) counts[0]++;
+    if (a[1]()) counts[1]++;
+    if (a[2]()) counts[2]++;
+    if (a[3]()) counts[3]++;
+    if (a[4]()) counts[4]++;
+    if (a[5]()) counts[5]++;
+    if (a[6]()) counts[6]++;
+    if (a[7]()) counts[7]++;
+    });
+  unsigned long expect[N];
+  memcpy(expect, counts, sizeof(counts));
+
+  b[0].on( []() { counts[0]++; } );
+  b[1].on( []() { counts[1]++; } );
+  b[2].on( []() { counts[2]++; } );
+  b[3].on( []() { counts[3]++; } );
+  b[4].on( []() { counts[4]++; } );
+  b[5].on( []() { counts[5]++; } );
+  b[6].on( []() { counts[6]++; } );
+  b[7].on( []() { counts[7]++; } );
+  mock_ms = 0;
+  for (int i = 0; i < N; i++) b[i].reset();
+  double run_all = per_pass( []() { Every::run_all(); } );
+
+  for (int i = 0; i < N; i++) CHECK( counts[i] == expect[i] );
+  printf("ns per pass, %d timers\n", N);
+  printf("  if chain\t%.1f\n", chain);
+  printf("  run_all()\t%.1f\n", run_all);
+  }
@@ -0,0 +1,40 @@
+// Every::PatternOf<...> fires and steps tick for tick with the same Every::Pattern
+
+#include "every.h"
+#include "host_test.h"
+
+static const unsigned long pattern[] = { 300, 600, 1000, 1500 };
+Every::Pattern a(4, pattern), h;
+Every::PatternOf<300, 600, 1000, 1500> b;
+Every::Heartbeat hb;
+
+static_assert( sizeof(Every::PatternOf<100, 250>::IntervalT) == 1, "250 fits a byte");
+static_assert( sizeof(decltype(b)::IntervalT) == 2, "1500 fits a word");
+static_assert( sizeof(Every::PatternOf<70000, 3>::IntervalT) == 4, "70000 needs a long");
+
+int main() {
+  srand(2);
+  printf("sizeof Pattern %zu, PatternOf %zu\n", sizeof(a), sizeof(b));
+  CHECK( sizeof(b) < sizeof(a) );
+
+  // every msec, with some long loop()'s
+  for (unsigned long t = 0; t < 300000; t += 1 + (rand() % 9 == 0 ? rand() % 2000 : 0)) {
+    mock_ms = t;
+    CHECK( a() == b() );
+    CHECK( a.state == b.state );
+    CHECK( h() == hb() );
+    CHECK( h.state == hb.state );
+    if (t % 50000 == 0) { a.reset(); b.reset(); }
+    }
+
+  // registered, too
+  Every::PatternOf<300, 600, 1000, 1500> c;
+  Every::Scheduler::add(c); a.reset();
+  for (unsigned long t = 300000; t < 400000; t++) {
+    mock_ms = t;
+    Every::Scheduler::run();
+    CHECK( a() == c() );
+    CHECK( a.state == c.state );
+    }
+  puts("ok");
+  }
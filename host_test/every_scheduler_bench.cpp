@@ -0,0 +1,55 @@
+// Every::Scheduler (timer wheel) vs plain polling, cost per loop() pass
+// at 8, 64, 512 timers. One pass per simulated msec, intervals 10..5000 msec.
+// The wheel with each t1() asked is still a call per timer, take() only touches the ones that fired.
+// The host's millis() is nearly free, the AVR's isn't (cli, 4 byte copy), so millis()/pass is shown too.
+
+#include "every.h"
+#include "host_test.h"
+
+const unsigned long Passes = 200000;
+
+enum How { Polled, Asked, Taken };
+
+double per_pass(int n, How how, double &reads) {
+  srand(1);
+  mock_ms = 0;
+  Every *timers = new Every[n];
+  for (int i = 0; i < n; i++) {
+    timers[i].reset( (unsigned long) (10 + rand() % 4991) );
+    if (how != Polled) Every::Scheduler::add(timers[i]);
+    }
+
+  unsigned long fired = 0;
+  unsigned long reads_before = mock_clock_reads;
+  double start = host_ns();
+  for (unsigned long ms = 1; ms <= Passes; ms++) {
+    mock_ms = ms;
+    Every::Scheduler::run();
+    if (how == Taken) {
+      while (Every::Scheduler::take()) fired++;
+      }
+    else {
+      for (int i = 0; i < n; i++) fired += timers[i]();
+      }
+    }
+  double ns = (host_ns() - start) / Passes;
+  reads = double(mock_clock_reads - reads_before) / Passes;
+  keep(fired);
+  CHECK( fired > 0 );
+
+  for (int i = 0; i < n; i++) Every::Scheduler::remove(timers[i]);
+  delete [] timers;
+  return ns;
+  }
+
+int main() {
+  printf("timers\tpolled ns/pass\tmillis()/pass\twheel+t1() ns/pass\twheel+take() ns/pass\tmillis()/pass\n");
+  const int sizes[] = { 8, 64, 512 };
+  for (int n : sizes) {
+    double polled_reads, wheel_reads;
+    double polled = per_pass(n, Polled, polled_reads);
+    double asked = per_pass(n, Asked, wheel_reads);
+    double taken = per_pass(n, Taken, wheel_reads);
+    printf("%d\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n", n, polled, polled_reads, asked, taken, wheel_reads);
+    }
+  }
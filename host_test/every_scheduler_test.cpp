@@ -0,0 +1,63 @@
+// A registered Every/Timer/Pattern fires exactly when an unregistered twin does
+
+#include "every.h"
+#include "host_test.h"
+
+const int N = 200;
+const unsigned long Start = ~0UL - 100000; // so millis() rolls over halfway
+
+int main() {
+  srand(1);
+  mock_ms = Start;
+  Every *a = new Every[N], *b = new Every[N];
+  Timer *ta[N], *tb[N];
+  for (int i = 0; i < N; i++) {
+    unsigned long interval = 1 + rand() % (i % 3 == 0 ? 20000 : 300); // some past the wheel
+    a[i].reset(interval); b[i].reset(interval); Every::Scheduler::add(b[i]);
+    ta[i] = new Timer(interval * 3); tb[i] = new Timer(interval * 3); Every::Scheduler::add(*tb[i]);
+    }
+  Every::Pattern pa, pb;
+  pa.reset(); Every::Scheduler::add(pb);
+
+  unsigned long fired = 0;
+  // loop passes every msec, and some late ones
+  for (unsigned long t = 0; t < 200000; t += (rand() % 3 == 0 ? rand() % 7 : 1)) {
+    mock_ms = Start + t;
+    Every::Scheduler::run();
+    for (int i = 0; i < N; i++) {
+      boolean x = a[i]();
+      CHECK( x == b[i]() );
+      fired += x;
+      CHECK( (*ta[i])() == (*tb[i])() );
+      if (t == 100000 && i % 5 == 0) { a[i].reset(); b[i].reset(); ta[i]->reset(); tb[i]->reset(); }
+      }
+    CHECK( pa() == pb() );
+    }
+  CHECK( fired > 0 );
+
+  // take() hands back the same ones, without asking the rest
+  Every *c = new Every[N];
+  Every::Pattern pc;
+  for (int i = 0; i < N; i++) { Every::Scheduler::remove(b[i]); Every::Scheduler::remove(*tb[i]); }
+  Every::Scheduler::remove(pb);
+  mock_ms = Start;
+  for (int i = 0; i < N; i++) { a[i].reset(); c[i].reset(a[i].interval); Every::Scheduler::add(c[i]); }
+  pa.reset(); Every::Scheduler::add(pc);
+  unsigned long taken = 0;
+  for (unsigned long t = 0; t < 100000; t += (rand() % 3 == 0 ? rand() % 7 : 1)) {
+    mock_ms = Start + t;
+    Every::Scheduler::run();
+    boolean took[N] = {}, took_pattern = false;
+    while (EveryScheduled *x = Every::Scheduler::take()) {
+      taken++;
+      if (x == &pc) took_pattern = true;
+      else took[ (Every *) x - c ] = true;
+      }
+    for (int i = 0; i < N; i++) CHECK( a[i]() == took[i] );
+    CHECK( pa() == took_pattern );
+    CHECK( pa.state == pc.state );
+    }
+  CHECK( taken > 0 );
+
+  printf("ok, %lu fired, %lu taken\n", fired, taken);
+  }
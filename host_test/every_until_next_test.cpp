@@ -0,0 +1,136 @@
+// until_next(): a loop() that sleeps till then does the same work as one that spins every msec,
+// in far fewer passes. And Scheduler::until_next() is the brute-force minimum over its timers.
+
+#include "every.h"
+#include "Blinker.h"
+#include "debounce.h"
+#include "host_test.h"
+#include <vector>
+
+// a typical mix: sample a sensor, update a display, blink, debounce a button, an idle timeout
+Every sample(20), display(100);
+Every::Heartbeat heartbeat;
+Timer timeout(30000);
+Blinker led(LED_BUILTIN, 500);
+Debounce *button; // a fresh one for each run
+
+const unsigned long Minute = 60000;
+// the raw button: a press and a release, each bouncing for 4 msec. The sleeper wakes on these (pin change)
+const unsigned long edges[] = { 3000, 3001, 3002, 3003, 3004, 3500, 3501, 3502, 3503, 42000, 42002, 42003, 42700, 42701 };
+const int Edges = sizeof(edges) / sizeof(edges[0]);
+boolean raw(unsigned long ms) {
+  boolean level = HIGH;
+  for (int i = 0; i < Edges && edges[i] <= ms; i++) level = !level;
+  return level;
+  }
+
+struct Event {
+  unsigned long ms;
+  byte what;
+  bool operator==(const Event &b) const { return ms == b.ms && what == b.what; }
+  };
+
+void start() {
+  mock_ms = 0;
+  sample.reset(); display.reset(); heartbeat.reset(); timeout.reset();
+  led.state(LOW);
+  delete button;
+  button = new Debounce(20);
+  }
+
+// one loop() pass, what happened
+byte pass(boolean &was_pressed) {
+  byte what = 0;
+  if (sample()) what |= 1;
+  if (display()) what |= 2;
+  if (heartbeat()) what |= 4;
+  if (timeout()) what |= 8;
+  boolean blink = led.state();
+  if (led.blink() != blink) what |= 16;
+  boolean pressed = (*button)( raw(mock_ms) ) == LOW;
+  if (pressed != was_pressed) { what |= 32; if (pressed) timeout.reset(); }
+  was_pressed = pressed;
+  return what;
+  }
+
+int main() {
+  Every::Scheduler::add(display); Every::Scheduler::add(heartbeat); Every::Scheduler::add(timeout);
+
+  // spin: a pass every msec
+  std::vector<Event> spun;
+  unsigned long spin_passes = 0;
+  boolean pressed = false;
+  start();
+  for (unsigned long ms = 1; ms <= Minute; ms++) {
+    mock_ms = ms;
+    Every::Scheduler::run();
+    byte what = pass(pressed);
+    spin_passes++;
+    if (what) spun.push_back( Event{ms, what} );
+    }
+
+  // sleep: till until_next(), or the next button edge
+  std::vector<Event> slept;
+  unsigned long sleep_passes = 0;
+  pressed = false;
+  start();
+  Every::Scheduler::remove(display); Every::Scheduler::remove(heartbeat); Every::Scheduler::remove(timeout);
+  Every::Scheduler::add(display); Every::Scheduler::add(heartbeat); Every::Scheduler::add(timeout);
+  unsigned long ms = 1;
+  while (ms <= Minute) {
+    mock_ms = ms;
+    Every::Scheduler::run();
+    byte what = pass(pressed);
+    sleep_passes++;
+    if (what) slept.push_back( Event{ms, what} );
+
+    unsigned long sleep = Every::until_next(sample, led, *button); // and the registered ones
+    if (sleep == 0) sleep = 1; // something fired but isn't noticed till the next run()
+    for (int i = 0; i < Edges; i++) {
+      if (edges[i] > ms && edges[i] - ms < sleep) sleep = edges[i] - ms;
+      }
+    ms = sleep > Minute ? Minute + 1 : ms + sleep;
+    }
+
+  printf("spinning: %lu passes, %lu wasted\n", spin_passes, spin_passes - spun.size());
+  printf("sleeping: %lu passes, %lu wasted. %lu passes avoided\n", sleep_passes, sleep_passes - slept.size(), spin_passes - sleep_passes);
+  CHECK( spun.size() == slept.size() );
+  for (size_t i = 0; i < spun.size(); i++) CHECK( spun[i] == slept[i] );
+
+  // Scheduler::until_next() vs the minimum of next_deadline()'s, with late loop()'s
+  srand(9);
+  Every::Scheduler::remove(display); Every::Scheduler::remove(heartbeat); Every::Scheduler::remove(timeout);
+  const int N = 40;
+  Every timers[N];
+  Timer t(500);
+  mock_ms = 0;
+  for (int i = 0; i < N; i++) { timers[i].reset( (unsigned long) (1 + rand() % 5000) ); Every::Scheduler::add(timers[i]); }
+  Every::Scheduler::add(t);
+  for (unsigned long ms = 0; ms < 200000; ms += 1 + (rand() % 4 == 0 ? rand() % 300 : 0)) {
+    mock_ms = ms;
+    Every::Scheduler::run();
+    unsigned long least = t.next_deadline();
+    for (int i = 0; i < N; i++) if (timers[i].next_deadline() < least) least = timers[i].next_deadline();
+    CHECK( Every::Scheduler::until_next() == least );
+    t();
+    for (int i = 0; i < N; i++) timers[i]();
+    }
+  
+  // .on()'s count too. An Interrupt one is read by the (atomic) Interrupt part, not again by the .on() part
+  for (int i = 0; i < N; i++) Every::Scheduler::remove(timers[i]);
+  Every::Scheduler::remove(t);
+  CHECK( Every::until_next() == Every::Never );
+  Every by_interrupt(300), plain(700);
+  mock_ms = 300000;
+  CHECK( Every::Interrupt::add(by_interrupt) );
+  plain.reset();
+  CHECK( by_interrupt.on( [](){} ) && plain.on( [](){} ) );
+  mock_ms += 100;
+  CHECK( Every::until_next() == 200 );
+  by_interrupt.off();
+  CHECK( Every::until_next() == 200 ); // still registered with Interrupt
+  Every::Interrupt::remove(by_interrupt);
+  CHECK( Every::until_next() == 600 );
+  plain.off();
+  CHECK( Every::until_next() == Every::Never );
+  }
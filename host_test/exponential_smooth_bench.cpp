@@ -0,0 +1,57 @@
+// ExponentialSmooth: 1M samples one average() at a time, vs average_block(), vs the original formula.
+// And ExponentialSmoothChannels<int, 8> on the same 1M samples as 125000 frames,
+// and ExponentialSmoothShift<int, 3> (integer only) vs ExponentialSmooth<int>(8).
+
+#include "ExponentialSmooth.h"
+#include "host_test.h"
+
+const int N = 1000000;
+int in[N], out[N];
+
+// what average() used to be: two divides per sample
+struct Original {
+  float _smoothed = 0;
+  const float factor;
+  Original(float factor) : factor(factor) {}
+  int average(const int raw_value) { _smoothed = raw_value / factor + _smoothed - _smoothed / factor; return (int) _smoothed; }
+  };
+
+template <typename F>
+double ms_for(F run) {
+  double best = 1e30;
+  for (int rep = 0; rep < 5; rep++) {
+    double start = host_ns();
+    run();
+    keep(out);
+    double ms = (host_ns() - start) / 1e6;
+    if (ms < best) best = ms;
+    }
+  return best;
+  }
+
+int main() {
+  srand(5);
+  for (int i = 0; i < N; i++) in[i] = 512 + (int)(300 * sin(i / 100.0)) + rand() % 50 - 25;
+
+  Original original(7);
+  ExponentialSmooth<int> one(7), block(7);
+  ExponentialSmoothChannels<int, 8> channels(7);
+  ExponentialSmooth<int> by_float(8);
+  ExponentialSmoothShift<int, 3> by_shift;
+  one.reset(0); block.reset(0); channels.reset(0); by_float.reset(0); by_shift.reset(0);
+
+  double t_original = ms_for( [&]() { for (int i = 0; i < N; i++) out[i] = original.average(in[i]); } );
+  double t_one = ms_for( [&]() { for (int i = 0; i < N; i++) out[i] = one.average(in[i]); } );
+  double t_block = ms_for( [&]() { block.average_block(in, out, N); } );
+  double t_channels = ms_for( [&]() { channels.average_block(in, out, N / 8); } );
+  double t_float = ms_for( [&]() { for (int i = 0; i < N; i++) out[i] = by_float.average(in[i]); } );
+  double t_shift = ms_for( [&]() { for (int i = 0; i < N; i++) out[i] = by_shift.average(in[i]); } );
+
+  printf("msec per 1M samples (best of 5)\n");
+  printf("  original formula\t%.2f\n", t_original);
+  printf("  average()\t%.2f\n", t_one);
+  printf("  average_block()\t%.2f\n", t_block);
+  printf("  8 channels\t%.2f\n", t_channels);
+  printf("  factor 8, float\t%.2f\n", t_float);
+  printf("  factor 8, shift\t%.2f\n", t_shift);
+  }
@@ -0,0 +1,96 @@
+// ExponentialSmooth's average_block(), and ExponentialSmoothChannels, give what per-sample average() does.
+// ExponentialSmoothShift vs the exact (double) smoother, next to ExponentialSmooth<int>: how far off each is.
+
+#include "ExponentialSmooth.h"
+#include "host_test.h"
+
+const int N = 10000;
+const int Channels = 8;
+int in[N], out[N], expect[N];
+
+int main() {
+  srand(5);
+  for (int i = 0; i < N; i++) in[i] = 512 + (int)(300 * sin(i / 100.0)) + rand() % 50 - 25;
+
+  // one at a time
+  ExponentialSmooth<int> one(7);
+  one.reset(100);
+  for (int i = 0; i < N; i++) expect[i] = one.average(in[i]);
+
+  // block, in odd sized pieces
+  ExponentialSmooth<int> block(7);
+  block.reset(100);
+  for (int i = 0; i < N; ) {
+    int n = i + 37 < N ? 37 : N - i;
+    CHECK( block.average_block(in + i, out + i, n) == expect[i + n - 1] );
+    i += n;
+    }
+  CHECK( !memcmp(out, expect, sizeof(out)) );
+  CHECK( block.value() == one.value() );
+  // in place
+  ExponentialSmooth<int> inplace(7);
+  inplace.reset(100);
+  memcpy(out, in, sizeof(out));
+  inplace.average_block(out, out, N);
+  CHECK( !memcmp(out, expect, sizeof(out)) );
+  // float
+  ExponentialSmooth<float> f1(3.5), f2(3.5);
+  f1.reset(0); f2.reset(0);
+  float fin[100], fout[100];
+  for (int i = 0; i < 100; i++) fin[i] = in[i] * 0.25f;
+  f2.average_block(fin, fout, 100);
+  for (int i = 0; i < 100; i++) CHECK( f1.average(fin[i]) == fout[i] );
+
+  // channels: in[] as N/Channels frames of [Channels], each channel against its own ExponentialSmooth
+  ExponentialSmoothChannels<int, Channels> channels(7), by_channel(7), framewise(7);
+  ExponentialSmooth<int> each[Channels];
+  for (int c = 0; c < Channels; c++) { each[c].set_factor(7); each[c].reset(c * 10); }
+  for (int c = 0; c < Channels; c++) { channels.reset(c, c * 10); by_channel.reset(c, c * 10); framewise.reset(c, c * 10); }
+  const int Frames = N / Channels;
+  channels.average_block(in, out, Frames);
+  int frame[Channels];
+  for (int f = 0; f < Frames; f++) {
+    framewise.average(in + f * Channels, frame);
+    for (int c = 0; c < Channels; c++) {
+      int e = each[c].average(in[f * Channels + c]);
+      CHECK( out[f * Channels + c] == e );
+      CHECK( frame[c] == e );
+      CHECK( by_channel.average(c, in[f * Channels + c]) == e );
+      }
+    }
+  for (int c = 0; c < Channels; c++) CHECK( channels.value(c) == each[c].value() );
+
+  // the Shift one, factor 8, against the exact smoothing. Both truncate, so within a count
+  ExponentialSmooth<int> by_float(8);
+  ExponentialSmoothShift<int, 3> by_shift;
+  by_float.reset(0); by_shift.reset(0);
+  double exact = 0, worst_float = 0, worst_shift = 0, sum_float = 0, sum_shift = 0;
+  for (int i = 0; i < N; i++) {
+    exact += (in[i] - exact) / 8;
+    double e = fabs(by_float.average(in[i]) - exact);
+    sum_float += e;
+    if (e > worst_float) worst_float = e;
+    e = fabs(by_shift.average(in[i]) - exact);
+    sum_shift += e;
+    if (e > worst_shift) worst_shift = e;
+    }
+  printf("vs exact, factor 8: ExponentialSmooth<int> worst %.2f mean %.3f, ExponentialSmoothShift worst %.2f mean %.3f\n",
+    worst_float, sum_float / N, worst_shift, sum_shift / N);
+  CHECK( worst_float < 1.01 && worst_shift < 1.01 );
+
+  // lands exactly on a steady input, up and down
+  ExponentialSmoothShift<int, 4> steady;
+  steady.reset(0);
+  for (int i = 0; i < 1000; i++) steady.average(1000);
+  CHECK( steady.value() == 1000 );
+  for (int i = 0; i < 1000; i++) steady.average(-37);
+  CHECK( steady.value() == -37 );
+
+  // an AVR int accumulator: a 10 bit analogRead << 5 fits in 16 bits
+  ExponentialSmoothShift<int16_t, 5, int16_t> adc;
+  adc.reset(0);
+  for (int i = 0; i < 2000; i++) CHECK( adc.average(1023) >= 0 );
+  CHECK( adc.value() == 1023 );
+  adc.reset(1023);
+  CHECK( adc.value() == 1023 );
+  }
@@ -0,0 +1,6 @@
+// the globals for Arduino.h (the fake one here)
+unsigned long mock_ms, mock_us, mock_clock_reads;
+int mock_io_trace, mock_adc;
+byte mock_pin[64];
+int mock_analog[64];
+HardwareSerial Serial;
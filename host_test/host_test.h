@@ -0,0 +1,20 @@
+#pragma once
+
+// for the *_test.cpp and *_bench.cpp here
+
+#include <time.h>
+
+// fail the test (exit 1), with where
+#define CHECK(cond) do { \
+  if (!(cond)) { printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); exit(1); } \
+  } while (0)
+
+// real time, for benchmarks (the mock clock is just a number)
+inline double host_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+  }
+
+// so the optimizer can't throw away a result
+template <typename T> inline void keep(const T &v) { asm volatile("" : : "g"(&v) : "memory"); }
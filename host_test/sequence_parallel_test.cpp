@@ -0,0 +1,87 @@
+// LED timelines with Parallel<>, Race<> and Repeat<> on the mock clock
+
+#include "sequence_machine2.h"
+#include "host_test.h"
+
+typedef Sequence< DigitalWrite<2, HIGH>, WaitFor<100>, DigitalWrite<2, LOW>, WaitFor<100> > BlinkSlow;
+typedef Sequence< DigitalWrite<3, HIGH>, WaitFor<30>, DigitalWrite<3, LOW>, WaitFor<30> > BlinkFast;
+
+// both at once, then pin 4 for 50 when both are done
+Sequence< Parallel< Repeat<2, BlinkSlow>, Repeat<5, BlinkFast> >, DigitalWrite<4, HIGH>, WaitFor<50>, DigitalWrite<4, LOW> > fork_join;
+// the same alone, for comparison
+Sequence< Repeat<2, BlinkSlow> > slow_alone;
+Sequence< Repeat<5, BlinkFast> > fast_alone;
+// fast blinks till the 250 is up
+Sequence< Race< Repeat<100, BlinkFast>, WaitFor<250> >, DigitalWrite<4, HIGH> > race;
+
+// the pin changes: when, which, to what
+struct Edge { unsigned long ms; byte pin, level; };
+const int MaxEdges = 40;
+struct Timeline {
+  Edge edges[MaxEdges];
+  int count;
+  unsigned long last(byte pin) { for (int i = count - 1; i >= 0; i--) if (edges[i].pin == pin) return edges[i].ms; return 0; }
+  int of(byte pin) { int n = 0; for (int i = 0; i < count; i++) n += edges[i].pin == pin; return n; }
+  };
+
+// one pass per ms, till run_once() says it's been all the way through
+template <typename S> void play(S &s, Timeline &t) {
+  memset(mock_pin, 0, sizeof(mock_pin));
+  t.count = 0;
+  byte was[5] = {};
+  boolean running = true;
+  for (mock_ms = 1; running; mock_ms++) { // wait_for() uses 0 for "not started"
+    CHECK( mock_ms < 10000 );
+    running = s.run_once();
+    for (byte pin = 2; pin <= 4; pin++) {
+      if (mock_pin[pin] == was[pin]) continue;
+      was[pin] = mock_pin[pin];
+      CHECK( t.count < MaxEdges );
+      t.edges[t.count++] = { mock_ms, pin, was[pin] };
+      }
+    }
+  }
+
+// the same changes of pin, at the same times
+boolean same(Timeline &a, Timeline &b, byte pin) {
+  int i = 0, j = 0;
+  for (; ; i++, j++) {
+    while (i < a.count && a.edges[i].pin != pin) i++;
+    while (j < b.count && b.edges[j].pin != pin) j++;
+    if (i == a.count || j == b.count) return i == a.count && j == b.count;
+    if (a.edges[i].ms != b.edges[j].ms || a.edges[i].level != b.edges[j].level) return false;
+    }
+  }
+
+void print(const char *name, Timeline &t) {
+  printf("%s:", name);
+  for (int i = 0; i < t.count; i++) printf(" %lu:%d%s", t.edges[i].ms, t.edges[i].pin, t.edges[i].level ? "+" : "-");
+  printf("\n");
+  }
+
+int main() {
+  Timeline both, slow, fast, raced;
+  play(fork_join, both);
+  play(slow_alone, slow);
+  play(fast_alone, fast);
+  play(race, raced);
+  print("fork_join", both); print("slow", slow); print("fast", fast); print("race", raced);
+
+  // in parallel, each does exactly what it does alone (from one dispatch per pass)
+  CHECK( slow.of(2) == 4 && fast.of(3) == 10 );
+  CHECK( same(both, slow, 2) );
+  CHECK( same(both, fast, 3) );
+  // and the join waits for the longer one: pin 4 the pass after it's done
+  unsigned long joined = both.last(2) > both.last(3) ? both.last(2) : both.last(3);
+  CHECK( both.of(4) == 2 );
+  CHECK( both.edges[both.count - 2].pin == 4 && both.edges[both.count - 2].ms > joined );
+  CHECK( both.edges[both.count - 2].ms == 409 ); // slow's last WaitFor<100> started at 308
+  CHECK( both.edges[both.count - 1].ms - both.edges[both.count - 2].ms >= 50 );
+
+  // race: the 250 wins, no more blinks after it
+  CHECK( raced.edges[raced.count - 1].pin == 4 );
+  unsigned long won = raced.edges[raced.count - 1].ms;
+  CHECK( won >= 250 && won < 260 );
+  CHECK( raced.of(3) >= 8 ); // about 4 blinks in 250
+  CHECK( raced.last(3) < won );
+  }
@@ -0,0 +1,45 @@
+// Step throughput and RAM: machine (list in RAM), machine_P (list in PROGMEM), Sequence<> (list is the type)
+
+#include "sequence_machine2.h"
+#include "host_test.h"
+
+// 20 steps that finish at once, so every run() is a step
+unsigned long hits;
+template<int n> boolean bump(byte *) { hits += n; return true; }
+template<int n> struct Bump {
+  typedef SequenceNoState State;
+  static boolean step(State &) { hits += n; return true; }
+  };
+
+#define STEPS20(S) S<1>, S<2>, S<3>, S<4>, S<5>, S<6>, S<7>, S<8>, S<9>, S<10>, \
+  S<11>, S<12>, S<13>, S<14>, S<15>, S<16>, S<17>, S<18>, S<19>, S<20>
+#define BUMP(n) &bump<n>
+FunctionPointer in_ram[] = { BUMP(1), BUMP(2), BUMP(3), BUMP(4), BUMP(5), BUMP(6), BUMP(7), BUMP(8), BUMP(9), BUMP(10),
+  BUMP(11), BUMP(12), BUMP(13), BUMP(14), BUMP(15), BUMP(16), BUMP(17), BUMP(18), BUMP(19), BUMP(20) };
+const FunctionPointer in_flash[] PROGMEM = { BUMP(1), BUMP(2), BUMP(3), BUMP(4), BUMP(5), BUMP(6), BUMP(7), BUMP(8), BUMP(9), BUMP(10),
+  BUMP(11), BUMP(12), BUMP(13), BUMP(14), BUMP(15), BUMP(16), BUMP(17), BUMP(18), BUMP(19), BUMP(20) };
+Sequence< STEPS20(Bump) > typed;
+
+const unsigned long Steps = 20000000; // a multiple of 20
+
+template <typename M> double ns_per_step(M &m) {
+  hits = 0;
+  double start = host_ns();
+  for (unsigned long i = 0; i < Steps; i++) m.run();
+  double ns = (host_ns() - start) / Steps;
+  CHECK( hits == Steps / 20 * 210 ); // 1+2+...+20 per time through
+  return ns;
+  }
+
+int main() {
+  declare_machine(in_ram);
+  declare_machine_P(in_flash);
+
+  printf("20 steps\tns per step\tRAM bytes (here)\n");
+  printf("  machine\t%.1f\t%d + %d for the list\n", ns_per_step(in_ram_machine), (int) sizeof(in_ram_machine), (int) sizeof(in_ram));
+  printf("  machine_P\t%.1f\t%d\n", ns_per_step(in_flash_machine), (int) sizeof(in_flash_machine));
+  printf("  Sequence<>\t%.1f\t%d\n", ns_per_step(typed), (int) sizeof(typed));
+  // on AVR a FunctionPointer is 2 bytes
+  printf("10 sequences of 20 steps: the lists are %d bytes of RAM on AVR for machine, 0 for machine_P and Sequence<>\n",
+    10 * 20 * 2);
+  }
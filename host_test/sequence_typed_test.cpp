@@ -0,0 +1,91 @@
+// Sequence<> (typed steps) does the same as the old machine (FunctionPointer steps): wait_for, set_rand, triangle
+
+#include "sequence_machine2.h"
+#include "host_test.h"
+
+long r;
+int tf_last, tf_calls;
+void tf(int value, byte *, byte *) { tf_last = value; tf_calls++; }
+TriangleSettings ts = { 0, 40, 7, 5, 0 };
+
+// The old triangle()'s need 16 bytes here (a long is 8), more than machine's 8, when they have a step_delay.
+// So no step_delay's for the comparison. (8 bytes on AVR, which is fine)
+FunctionPointer old_style[] = {
+  &digitalWrite<13, HIGH>, &wait_for<200>, &digitalWrite<13, LOW>, &wait_for<150>,
+  &set_rand<&r, 10, 500>,
+  &triangle<5, 0, 30, 4, 3, 0>,
+  &triangle<&tf, ts>,
+  &wait_for<35>
+  };
+Sequence<
+  DigitalWrite<13, HIGH>, WaitFor<200>, DigitalWrite<13, LOW>, WaitFor<150>,
+  SetRand<&r, 10, 500>,
+  Triangle<5, 0, 30, 4, 3, 0>,
+  TriangleWith<&tf, ts>,
+  WaitFor<35>
+  > typed;
+
+// what we can see after each pass
+struct Seen {
+  int idx, led, analog;
+  long r;
+  int tf_last, tf_calls;
+  boolean operator==(const Seen &b) const {
+    return idx == b.idx && led == b.led && analog == b.analog && r == b.r && tf_last == b.tf_last && tf_calls == b.tf_calls;
+    }
+  };
+
+const int Passes = 5000; // 10ms each, several times through
+Seen old_seen[Passes], typed_seen[Passes];
+
+void reset() {
+  srand(1);
+  r = 0; tf_last = tf_calls = 0;
+  mock_pin[13] = 0; mock_analog[5] = 0;
+  }
+template <typename M> void replay(M &m, Seen *seen) {
+  reset();
+  for (int i = 0; i < Passes; i++) {
+    mock_ms = i * 10 + 1; // wait_for() uses 0 for "not started"
+    m.run();
+    seen[i] = { (int) m.idx, mock_pin[13], mock_analog[5], r, tf_last, tf_calls };
+    }
+  }
+
+// Only the current step's State is initialized, when we get to it
+int checked = 0;
+struct Dirty {
+  struct State { unsigned long a[2]; };
+  static boolean step(State &s) { s.a[0] = s.a[1] = ~0UL; return true; }
+  };
+struct Clean {
+  struct State { unsigned long a[2]; };
+  static boolean step(State &s) { CHECK( s.a[0] == 0 && s.a[1] == 0 ); checked++; return true; }
+  };
+Sequence< Dirty, Clean, Dirty, Clean > clean;
+
+int main() {
+  declare_machine(old_style);
+  replay(old_style_machine, old_seen);
+  replay(typed, typed_seen);
+
+  int laps = 0, ramps = 0;
+  for (int i = 0; i < Passes; i++) {
+    if (!(old_seen[i] == typed_seen[i])) {
+      printf("pass %d: old idx %d led %d analog %d r %ld tf %d/%d, typed idx %d led %d analog %d r %ld tf %d/%d\n", i,
+        old_seen[i].idx, old_seen[i].led, old_seen[i].analog, old_seen[i].r, old_seen[i].tf_last, old_seen[i].tf_calls,
+        typed_seen[i].idx, typed_seen[i].led, typed_seen[i].analog, typed_seen[i].r, typed_seen[i].tf_last, typed_seen[i].tf_calls);
+      }
+    CHECK( old_seen[i] == typed_seen[i] );
+    if (i && typed_seen[i].idx == 0 && typed_seen[i - 1].idx != 0) laps++;
+    if (typed_seen[i].analog == 30) ramps++;
+    }
+  printf("%d passes, %d times through, %d tf calls. sizeof machine %d + list %d, Sequence<> %d\n",
+    Passes, laps, typed_seen[Passes - 1].tf_calls, (int) sizeof(old_style_machine), (int) sizeof(old_style), (int) sizeof(typed));
+  CHECK( laps > 5 );
+  CHECK( ramps > 0 );
+  CHECK( sizeof(typed) < sizeof(old_style_machine) );
+
+  for (int i = 0; i < 8; i++) clean.run();
+  CHECK( checked == 4 );
+  }
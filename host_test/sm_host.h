@@ -0,0 +1,14 @@
+#pragma once
+
+// for the sm_*.cpp here, which get built for both engines (see the Makefile)
+
+#include "state_machine.h"
+
+// declare a state ahead of its STATE(), like the "temporary" declarations in state_machine.h's notes
+#ifdef STATE_MACHINE_TABLE
+#define SM_DECLARE(name) const StateRow *_##name##_xtion();
+#define SM_ENGINE "table"
+#else
+#define SM_DECLARE(name) StateXtionFnPtr_ _##name##_xtion(StateMachine &sm);
+#define SM_ENGINE "function"
+#endif
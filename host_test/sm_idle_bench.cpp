@@ -0,0 +1,61 @@
+// 20 idle machines: parked on an SMEvent (sm_wait_event) vs polling a flag, per StateMachineScheduler::run() pass
+
+#define SM_MAX_MACHINES 20
+#include "sm_host.h"
+#include "host_test.h"
+
+SM_DECLARE(parked) SM_DECLARE(polling) SM_DECLARE(work)
+
+const byte Machines = 20;
+SMEvent go;
+boolean flag = false;
+unsigned long works;
+
+void work() { works++; }
+SIMPLESTATEAS(parked, (sm_wait_event<go>), work)
+boolean polling() { if (!flag) return true; flag = false; return false; }
+SIMPLESTATEAS(polling, polling, work)
+SIMPLESTATE(work, parked) // not used for the polling ones
+
+StateMachine sleepers[Machines] = {
+  _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion,
+  _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion,
+  _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion,
+  _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion, _parked_xtion
+  };
+StateMachine pollers[Machines] = {
+  _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion,
+  _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion,
+  _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion,
+  _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion, _polling_xtion
+  };
+
+const unsigned long Passes = 2000000;
+
+double passes(StateMachine *machines) {
+  while (StateMachineScheduler::state().count) {
+    StateMachineScheduler::remove( *StateMachineScheduler::state().machines[0].machine );
+    }
+  for (byte i = 0; i < Machines; i++) StateMachineScheduler::add(machines[i]);
+  StateMachineScheduler::run(); // the first run parks
+
+  unsigned long ran = 0;
+  double start = host_ns();
+  for (unsigned long i = 0; i < Passes; i++) ran += StateMachineScheduler::run();
+  double ns = (host_ns() - start) / Passes;
+  keep(ran);
+  return ns;
+  }
+
+int main() {
+  // nothing happens during the timing, that's "idle"
+  double parked_ns = passes(sleepers);
+  for (byte i = 0; i < Machines; i++) CHECK( StateMachineScheduler::stats(sleepers[i])->runs == 1 );
+  double polling_ns = passes(pollers);
+  for (byte i = 0; i < Machines; i++) CHECK( StateMachineScheduler::stats(pollers[i])->runs == Passes + 1 );
+  CHECK( works == 0 );
+
+  printf("%s engine, %d idle machines\n", SM_ENGINE, Machines);
+  printf("  parked on an SMEvent\t%.1f ns per pass\n", parked_ns);
+  printf("  polling a flag\t%.1f ns per pass\n", polling_ns);
+  }
@@ -0,0 +1,102 @@
+// StateMachineScheduler on a simulated clock: parking (sm_delay), stats, budgets, RoundRobin vs Priority
+
+#include "sm_host.h"
+#include "host_test.h"
+
+SM_DECLARE(wait) SM_DECLARE(a) SM_DECLARE(b) SM_DECLARE(busy)
+SM_DECLARE(work1) SM_DECLARE(work2) SM_DECLARE(work3)
+SM_DECLARE(patient) SM_DECLARE(idle) SM_DECLARE(there)
+
+// a machine that mostly waits: sm_delay<100>, a, b, again
+int na = 0, nb = 0;
+void a() { na++; }
+void b() { nb++; }
+SIMPLESTATEAS(wait, sm_delay<100>, a)
+SIMPLESTATE(a, b)
+SIMPLESTATE(b, wait)
+STATEMACHINE(waiter, wait)
+
+// one that never waits
+boolean busy() { return true; }
+SIMPLESTATE(busy, busy)
+STATEMACHINE(spinner, busy)
+
+// ones that take 400 usec a run
+boolean work1() { mock_us += 400; return true; }
+boolean work2() { mock_us += 400; return true; }
+boolean work3() { mock_us += 400; return true; }
+SIMPLESTATE(work1, work1)
+SIMPLESTATE(work2, work2)
+SIMPLESTATE(work3, work3)
+STATEMACHINE(w1, work1)
+STATEMACHINE(w2, work2)
+STATEMACHINE(w3, work3)
+
+// a park doesn't outlive its state: a GOTOWHEN leaves the sm_delay early
+unsigned long there_at = 0;
+boolean soon() { return millis() >= 10; }
+void idle() {}
+void there() { if (!there_at) there_at = millis(); }
+STATEAS(patient, (sm_delay<1000>), idle)
+  GOTOWHEN(soon, there)
+  END_STATE
+SIMPLESTATE(idle, idle)
+SIMPLESTATE(there, there)
+STATEMACHINE(patience, patient)
+
+void clear() {
+  while (StateMachineScheduler::state().count) {
+    StateMachineScheduler::remove( *StateMachineScheduler::state().machines[0].machine );
+    }
+  }
+
+int main() {
+  printf("%s engine\n", SM_ENGINE);
+
+  // parking, and priority order
+  CHECK( StateMachineScheduler::add(waiter) );
+  CHECK( StateMachineScheduler::add(spinner, 5) );
+  CHECK( !StateMachineScheduler::add(spinner) ); // already
+  CHECK( StateMachineScheduler::state().machines[0].machine == &spinner );
+  for (unsigned long t = 0; t < 10000; t++) {
+    mock_ms = t;
+    StateMachineScheduler::run();
+    }
+  StateMachineStats *w = StateMachineScheduler::stats(waiter), *s = StateMachineScheduler::stats(spinner);
+  printf("waiter: %lu runs, %lu parked, %lu transitions. a %d, b %d\n", w->runs, w->parked, w->transitions, na, nb);
+  CHECK( w->runs + w->parked == 10000 );
+  CHECK( na >= 95 && na <= 100 ); // a cycle is 100 msec + a pass for each of a, b, and wait's first run
+  CHECK( nb == na || nb == na - 1 );
+  CHECK( w->runs <= 4 * (unsigned long) na + 4 ); // only runs to get somewhere
+  CHECK( w->transitions >= 3 * (unsigned long) na - 3 );
+  CHECK( s->runs == 10000 && s->parked == 0 && s->transitions == 0 );
+  clear();
+
+  // a budget: RoundRobin shares it
+  StateMachineScheduler::add(w1, 3); StateMachineScheduler::add(w2, 2); StateMachineScheduler::add(w3, 1);
+  for (int pass = 0; pass < 300; pass++) {
+    CHECK( StateMachineScheduler::run(700) == 2 ); // 400 + 400 is over
+    }
+  unsigned long r1 = StateMachineScheduler::stats(w1)->runs, r2 = StateMachineScheduler::stats(w2)->runs, r3 = StateMachineScheduler::stats(w3)->runs;
+  printf("RoundRobin: %lu %lu %lu runs\n", r1, r2, r3);
+  CHECK( r1 == 200 && r2 == 200 && r3 == 200 );
+  CHECK( StateMachineScheduler::stats(w1)->run_us == 200 * 400 );
+
+  // Priority always starts at the top
+  StateMachineScheduler::reset_stats();
+  StateMachineScheduler::mode(StateMachineScheduler::Priority);
+  for (int pass = 0; pass < 300; pass++) StateMachineScheduler::run(700);
+  r1 = StateMachineScheduler::stats(w1)->runs, r2 = StateMachineScheduler::stats(w2)->runs, r3 = StateMachineScheduler::stats(w3)->runs;
+  printf("Priority: %lu %lu %lu runs\n", r1, r2, r3);
+  CHECK( r1 == 300 && r2 == 300 && r3 == 0 );
+  StateMachineScheduler::mode(StateMachineScheduler::RoundRobin);
+  clear();
+
+  StateMachineScheduler::add(patience);
+  for (unsigned long t = 0; t < 2000; t++) {
+    mock_ms = t;
+    StateMachineScheduler::run();
+    }
+  printf("there at %lu\n", there_at);
+  CHECK( there_at == 11 ); // left at 10, ran at 11. Not 1000
+  }
@@ -0,0 +1,132 @@
+// SUPERSTATE's: the SM_Start/SM_Finish order across superstates (nested too), their GOTOWHEN's, and _history
+
+#include "sm_host.h"
+#include "host_test.h"
+
+SM_DECLARE(op) SM_DECLARE(op_history) SM_DECLARE(inner) SM_DECLARE(a) SM_DECLARE(b) SM_DECLARE(c) SM_DECLARE(safe)
+SM_DECLARE(before) SM_DECLARE(waits) SM_DECLARE(on_entry) SM_DECLARE(after)
+
+// what happened, "a+" is a's SM_Start, "a-" its SM_Finish
+char log_[200];
+void log_phase(const char *name, StateMachinePhase phase) {
+  if (phase == SM_Running) return;
+  if (*log_) strcat(log_, " ");
+  strcat(log_, name);
+  strcat(log_, phase == SM_Start ? "+" : "-");
+  }
+// and check it, then clear it
+#define CHECK_LOG(expect) do { \
+  if (strcmp(log_, expect)) printf("got \"%s\"\n", log_); \
+  CHECK( !strcmp(log_, expect) ); \
+  *log_ = 0; \
+  } while (0)
+
+boolean estop_now = false, clear_now = false, skip_now = false;
+boolean estop() { return estop_now; }
+boolean cleared() { return clear_now; }
+boolean skip() { return skip_now; }
+
+// states that run for n passes
+#define RUNS(name, n) boolean name(StateMachine &, StateMachinePhase phase) { \
+  static int runs; \
+  log_phase(#name, phase); \
+  if (phase == SM_Start) runs = 0; \
+  return phase != SM_Finish && ++runs < n; \
+  }
+RUNS(a, 3) RUNS(b, 2) RUNS(c, 4) RUNS(safe, 1000)
+void op_act(StateMachine &, StateMachinePhase phase) { log_phase("op", phase); }
+void inner_act(StateMachine &, StateMachinePhase phase) { log_phase("inner", phase); }
+
+SUPERSTATEAS(op, op_act, a)
+  GOTOWHEN(estop, safe)
+  END_SUPERSTATE
+SUPERSTATEASIN(op, inner, inner_act, b)
+  GOTOWHEN(skip, a)
+  END_SUPERSTATE
+SIMPLESTATEIN(op, a, b)
+SIMPLESTATEIN(inner, b, c)
+SIMPLESTATEIN(inner, c, a)
+STATE(safe, safe)
+  GOTOWHEN(cleared, op_history)
+  END_STATE
+STATEMACHINE(machine, op)
+
+void run(int n = 1) { while (n--) machine.run(); }
+
+// a superstate whose first state waits right away: it should park on that first step
+SMEvent ready;
+int afters = 0;
+void before() {}
+void after() { afters++; }
+SIMPLESTATE(before, waits)
+SUPERSTATE(waits, on_entry)
+  END_SUPERSTATE
+SIMPLESTATEASIN(waits, on_entry, (sm_wait_event<ready>), after)
+SIMPLESTATE(after, after)
+STATEMACHINE(waiter, before)
+
+int main() {
+  printf("%s engine\n", SM_ENGINE);
+
+  // entering: outer superstate first, then the state
+  run();
+  CHECK_LOG("op+ a+");
+  // a to b: b enters "inner", still in "op"
+  run(3);
+  CHECK_LOG("a- inner+ b+");
+  // within "inner": nothing for the superstates
+  run(2);
+  CHECK_LOG("b- c+");
+  // c to a: leaves "inner" only
+  run(4);
+  CHECK_LOG("c- inner- a+");
+
+  // E-stop from op, while in b (so nested): leave inner then op, inner first
+  run(3);
+  CHECK_LOG("a- inner+ b+");
+  estop_now = true;
+  run();
+  estop_now = false;
+  CHECK_LOG("b-");
+  run(); // the superstates change at the start of the new state's first run
+  CHECK_LOG("inner- op- safe+");
+
+  // back to op's history: the last state directly in "op" was a, b was in "inner".
+  // And a restarts from its first pass
+  run(5);
+  CHECK_LOG("");
+  clear_now = true;
+  run();
+  clear_now = false;
+  run();
+  CHECK_LOG("safe- op+ a+");
+  run(3);
+  CHECK_LOG("a- inner+ b+");
+
+  // inner's GOTOWHEN, checked after b's own (none), before op's
+  skip_now = estop_now = true;
+  run();
+  skip_now = estop_now = false;
+  run();
+  CHECK_LOG("b- inner- a+");
+
+  // a restart() leaves them all
+  run(3);
+  CHECK_LOG("a- inner+ b+");
+  machine.restart(_safe_xtion);
+  run();
+  CHECK_LOG("b- inner- op- safe+");
+
+  // the superstate hands over to on_entry, which parks: not a state change, so it stays parked
+  StateMachineScheduler::add(waiter);
+  const StateMachineStats *st = StateMachineScheduler::stats(waiter);
+  for (int i = 0; i < 10; i++) StateMachineScheduler::run();
+  printf("waiter: runs %lu parked %lu transitions %lu\n", st->runs, st->parked, st->transitions);
+  CHECK( st->runs == 2 ); // before, then on_entry's first step
+  CHECK( st->parked == 8 );
+  CHECK( st->transitions == 1 ); // before -> waits
+  CHECK( waiter.waiting );
+  ready = true;
+  for (int i = 0; i < 3; i++) StateMachineScheduler::run();
+  CHECK( st->transitions == 2 && afters == 2 );
+  }
@@ -0,0 +1,3 @@
+// sm_transitions_bench with SM_TRACE on: the difference is what a trace record costs
+#define SM_TRACE 32
+#include "sm_transitions_bench.cpp"
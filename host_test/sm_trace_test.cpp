@@ -0,0 +1,57 @@
+// SM_TRACE: what goes in the ring, the wrap, restart()'s, clear(). Prints a dump too (for sm-trace-decode's format)
+
+#define SM_TRACE 8
+#include "sm_host.h"
+#include "host_test.h"
+
+SM_DECLARE(on) SM_DECLARE(off)
+
+// what a record has for the state
+#ifdef STATE_MACHINE_TABLE
+#define SM_REF(name) ( (const void *) _##name##_xtion() )
+#else
+#define SM_REF(name) ( (const void *) _##name##_xtion )
+#endif
+
+void off() {}
+SIMPLESTATEAS(on, (sm_delay<100>), off)
+SIMPLESTATE(off, on)
+STATEMACHINE(blinky, on)
+
+int main() {
+  printf("%s engine\n", SM_ENGINE);
+  StateMachineTrace::State &s = StateMachineTrace::state();
+
+  // on for 100, off for a pass: 18 state changes at 100, 101, 202, 203 ... 917
+  for (mock_ms = 0; mock_ms < 1000; mock_ms++) blinky.run();
+  CHECK( s.wrapped );
+  CHECK( s.last_ms == 917 );
+
+  // the last 8, oldest first from s.next: 610 611 712 713 814 815 916 917
+  for (unsigned int n = 0; n < SM_TRACE; n++) {
+    StateMachineTraceRecord &r = s.records[ (s.next + n) & (SM_TRACE - 1) ];
+    boolean leaving_on = n % 2 == 0;
+    CHECK( r.machine == &blinky );
+    CHECK( r.dt == (leaving_on ? 101 : 1) ); // 509 to 610, 610 to 611, ...
+    CHECK( r.from == (leaving_on ? SM_REF(on) : SM_REF(off)) );
+    CHECK( r.to == (leaving_on ? SM_REF(off) : SM_REF(on)) );
+    CHECK( r.phase == (leaving_on ? SM_Running : SM_Start) ); // off is a one-shot: leaves on its first run
+    }
+
+  // a restart() is a record too, from SM_Finish
+  mock_ms = 950;
+  blinky.restart(_off_xtion);
+  StateMachineTraceRecord &r = s.records[ (s.next - 1) & (SM_TRACE - 1) ];
+  CHECK( r.dt == 33 && r.from == SM_REF(on) && r.to == SM_REF(off) && r.phase == SM_Finish );
+
+  StateMachineTrace::dump();
+
+  // clear, then a gap too long for the uint16 dt
+  StateMachineTrace::clear();
+  CHECK( !s.wrapped && s.next == 0 );
+  mock_ms = 100000;
+  blinky.run();
+  CHECK( s.next == 1 );
+  CHECK( s.records[0].dt == 0xFFFF ); // "at least"
+  CHECK( s.records[0].from == SM_REF(off) && s.records[0].to == SM_REF(on) );
+  }
@@ -0,0 +1,55 @@
+// State changes per second, for whichever engine this was built with (sm_transitions_bench-table is the table one)
+
+#include "sm_host.h"
+#include "host_test.h"
+
+SM_DECLARE(a) SM_DECLARE(b) SM_DECLARE(c) SM_DECLARE(d) SM_DECLARE(watch) SM_DECLARE(react)
+
+// a ring of one-shot states: every run() is a transition
+unsigned long laps;
+void a() { laps++; }
+void b() {}
+void c() {}
+void d() {}
+SIMPLESTATE(a, b)
+SIMPLESTATE(b, c)
+SIMPLESTATE(c, d)
+SIMPLESTATE(d, a)
+STATEMACHINE(ring, a)
+
+// a state that polls 4 GOTOWHEN's, the last one true every 8th run
+unsigned long polls;
+boolean no() { return false; }
+boolean eighth() { return (++polls & 7) == 0; }
+boolean watch() { return true; } // again
+void react() {}
+STATE(watch, watch)
+  GOTOWHEN(no, react)
+  GOTOWHEN(no, react)
+  GOTOWHEN(no, react)
+  GOTOWHEN(eighth, react)
+  END_STATE
+SIMPLESTATE(react, watch)
+STATEMACHINE(watcher, watch)
+
+const unsigned long Runs = 20000000;
+
+int main() {
+  double start = host_ns();
+  for (unsigned long i = 0; i < Runs; i++) ring.run();
+  double ring_ns = (host_ns() - start) / Runs;
+  CHECK( laps == Runs / 4 );
+
+  start = host_ns();
+  for (unsigned long i = 0; i < Runs; i++) watcher.run();
+  double watch_ns = (host_ns() - start) / Runs;
+  CHECK( polls > Runs * 8 / 9 - 1 ); // one per watch run
+
+  #ifdef SM_TRACE
+  printf("%s engine, SM_TRACE %d\n", SM_ENGINE, SM_TRACE);
+  #else
+  printf("%s engine\n", SM_ENGINE);
+  #endif
+  printf("  ring of 4 one-shot states\t%.1f ns per run, %.1fM transitions/sec\n", ring_ns, 1000 / ring_ns);
+  printf("  4 GOTOWHEN's per run\t%.1f ns per run\n", watch_ns);
+  }
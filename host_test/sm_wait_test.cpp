@@ -0,0 +1,95 @@
+// Machines parked on an SMEvent, a pin, or an event with a timeout. And GOTOWHEN's still get checked while waiting.
+
+#include "sm_host.h"
+#include "host_test.h"
+
+SM_DECLARE(idle) SM_DECLARE(work) SM_DECLARE(wait_or) SM_DECLARE(woke) SM_DECLARE(wait_pin) SM_DECLARE(pinned)
+SM_DECLARE(stuck) SM_DECLARE(escaped) SM_DECLARE(panel) SM_DECLARE(inner) SM_DECLARE(safe) SM_DECLARE(nothing)
+
+// an event
+SMEvent go;
+int works = 0;
+void work() { works++; }
+SIMPLESTATEAS(idle, (sm_wait_event<go>), work)
+SIMPLESTATE(work, idle)
+STATEMACHINE(worker, idle)
+
+// an event or a timeout. Via another state: going to yourself doesn't re-Start, so wouldn't restart the timeout
+SMEvent maybe;
+unsigned long woke_at[20];
+byte wakes = 0;
+void woke() { if (wakes < 20) woke_at[wakes++] = millis(); }
+SIMPLESTATEAS(wait_or, (sm_wait_event_or<maybe, 1000>), woke)
+SIMPLESTATE(woke, wait_or)
+STATEMACHINE(waiter, wait_or)
+
+// a pin
+const int Button = 5;
+unsigned long pinned_at = 0;
+void pinned() { if (!pinned_at) pinned_at = millis(); }
+SIMPLESTATEAS(wait_pin, (sm_wait_pin<Button, HIGH>), pinned)
+SIMPLESTATE(pinned, pinned)
+STATEMACHINE(pin_watcher, wait_pin)
+
+// waiting, but a GOTOWHEN of the state, or of a superstate, can leave anyway
+SMEvent never;
+unsigned long escaped_at = 0, safe_at = 0;
+boolean escape() { return millis() >= 5; }
+boolean estop() { return millis() >= 7; }
+void nothing() {}
+void escaped() { if (!escaped_at) escaped_at = millis(); }
+void safe() { if (!safe_at) safe_at = millis(); }
+STATEAS(stuck, (sm_wait_event<never>), nothing)
+  GOTOWHEN(escape, escaped)
+  END_STATE
+SIMPLESTATE(escaped, escaped)
+SIMPLESTATE(nothing, nothing)
+SUPERSTATE(panel, inner)
+  GOTOWHEN(estop, safe)
+  END_SUPERSTATE
+STATEASIN(panel, inner, (sm_wait_event<never>), nothing)
+  END_STATE
+SIMPLESTATE(safe, safe)
+STATEMACHINE(escaper, stuck)
+STATEMACHINE(stopper, panel)
+
+int main() {
+  printf("%s engine\n", SM_ENGINE);
+  StateMachineScheduler::add(worker);
+  StateMachineScheduler::add(waiter);
+  StateMachineScheduler::add(pin_watcher);
+  StateMachineScheduler::add(escaper);
+  StateMachineScheduler::add(stopper);
+
+  for (unsigned long t = 0; t < 10000; t++) {
+    mock_ms = t;
+    if (t % 1000 == 500) go = true;
+    if (t == 2500) maybe = true;
+    if (t == 7000) digitalWrite(Button, HIGH);
+    StateMachineScheduler::run();
+    CHECK( !go ); // taken the same pass
+    }
+
+  StateMachineStats *w = StateMachineScheduler::stats(worker);
+  printf("worker: %d works, %lu runs, %lu parked\n", works, w->runs, w->parked);
+  CHECK( works == 10 );
+  CHECK( w->runs <= 3 * 10 + 1 ); // idle's first run parks, then idle (takes go), work
+
+  StateMachineStats *o = StateMachineScheduler::stats(waiter);
+  printf("waiter: %lu runs, woke at", o->runs);
+  for (byte i = 0; i < wakes; i++) printf(" %lu", woke_at[i]);
+  printf("\n");
+  // timeouts, 1000 after the wait started (2 passes after the last wake), except maybe at 2500
+  const unsigned long expect[] = { 1001, 2003, 2501, 3503, 4505, 5507, 6509, 7511, 8513, 9515 };
+  CHECK( wakes == sizeof(expect) / sizeof(*expect) );
+  for (byte i = 0; i < wakes; i++) CHECK( woke_at[i] == expect[i] );
+  CHECK( o->runs == 3UL * wakes + 1 ); // wait_or's first run parks, then wait_or, woke each time
+
+  printf("pin at %lu, escaped at %lu, safe at %lu\n", pinned_at, escaped_at, safe_at);
+  CHECK( pinned_at == 7001 ); // the pass after
+  CHECK( StateMachineScheduler::stats(pin_watcher)->parked == 7000 - 1 ); // but the first pass
+  CHECK( StateMachineScheduler::stats(escaper)->parked == 0 ); // has GOTOWHEN's, can't park
+  CHECK( StateMachineScheduler::stats(stopper)->parked == 0 );
+  CHECK( escaped_at == 6 ); // left at 5
+  CHECK( safe_at == 8 ); // left at 7
+  }
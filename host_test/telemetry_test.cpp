@@ -0,0 +1,95 @@
+// Telemetry::record()'s through telemetry-decode (see the Makefile's telemetry-decode, make does it too):
+//   build/telemetry_test stream expect.csv | ../telemetry-decode > got.csv; diff expect.csv got.csv
+// Zeros (for the COBS), negatives, a wide record, clipping, stray Serial.print's, drops,
+// and an AutoBilevel whose derived columns the decoder has to add.
+// Without the arguments: just the checks, no binary on stdout.
+
+#define TELEMETRY_TX 128
+#include "auto_bilevel.h"
+#include "CapTouchCrossover.h"
+#include "host_test.h"
+
+boolean streaming;
+FILE *expect;
+
+// send what's in the ring
+void flush() {
+  Telemetry::State &s = Telemetry::state();
+  while (s.tail != s.head) {
+    if (streaming) Telemetry::run(Serial);
+    else s.tail = s.head;
+    }
+  }
+
+// what the decoder should print for the record we're about to make
+void header(const char *columns) { if (expect) fprintf(expect, "%s\n", columns); }
+template <typename... Ts>
+void expect_line(byte id, Ts... values) {
+  if (!expect) return;
+  fprintf(expect, "%d,%d", id, Telemetry::state().seq);
+  const long v[] = { (long) values... };
+  for (long x : v) fprintf(expect, ",%ld", x);
+  fprintf(expect, "\n");
+  }
+
+int main(int argc, char **argv) {
+  streaming = argc > 2;
+  if (streaming) CHECK( (expect = fopen(argv[2], "w")) );
+  Telemetry::State &s = Telemetry::state();
+
+  // plain values: zeros, negatives, the int16 edges
+  header("id,seq,v1,v2,v3,v4,v5,v6");
+  for (int i = 0; i < 20; i++) {
+    expect_line(TelemetryUser, i, 0, -i, 32767, -32768, i * 100);
+    CHECK( Telemetry::record(TelemetryUser, i, 0, -i, 32767, -32768, i * 100) );
+    flush();
+    }
+
+  // one value too big for an int16: all int32's. And clipped past an int32, NaN is 0
+  expect_line(TelemetryUser, 70000, -1, 0);
+  CHECK( Telemetry::record(TelemetryUser, 70000L, -1, 0) );
+  expect_line(TelemetryUser, 2147483647L, -2147483647L - 1, 0);
+  CHECK( Telemetry::record(TelemetryUser, 1e12, -1e12, NAN) );
+  flush();
+
+  // someone Serial.print's in the middle: the decoder skips it
+  if (streaming) { Serial.print("hello 0 there\n"); fflush(stdout); }
+
+  // an AutoBilevel: raw, fast, slow, significant, state on the wire, the decoder adds fast - significant, slow + state
+  AutoBilevel<int, 2, 5> touch(50);
+  header("id,seq,raw,fast,slow,significant,state,fast_less_significant,slow_plus_state");
+  boolean was_on = false;
+  for (int i = 0; i < 300; i++) {
+    int raw = 300 + (i >= 100 && i < 200 ? 200 : 0) + (i * 7) % 11;
+    touch.update(raw);
+    was_on |= touch.on();
+    expect_line(TelemetryAutoBilevel, raw, touch.fast.value(), touch.slow.value(), 50, touch.on(),
+      touch.fast.value() - 50, touch.slow.value() + touch.on());
+    CHECK( touch.telemetry(raw) );
+    flush();
+    }
+  CHECK( was_on );
+
+  // drops: the ring fills if nobody run()'s it. seq keeps counting, so the decoder sees the gap
+  unsigned int dropped = s.dropped;
+  int kept = 0;
+  header("id,seq,pin,state,slow,fast,slow_less_fast");
+  for (int i = 0; i < 20; i++) {
+    byte seq = s.seq;
+    if (Telemetry::record(TelemetryCapTouch, 14, 1, 300 + i, 290, 10 + i)) {
+      if (expect) fprintf(expect, "%d,%d,14,1,%d,290,%d\n", TelemetryCapTouch, seq, 300 + i, 10 + i);
+      kept++;
+      }
+    }
+  CHECK( kept > 0 && s.dropped - dropped == 20u - kept );
+  flush();
+  // and one more, after the gap
+  expect_line(TelemetryCapTouch, 15, -1, 280, 290, -10);
+  CHECK( Telemetry::record(TelemetryCapTouch, 15, -1, 280, 290, -10) );
+  flush();
+
+  if (expect) {
+    fclose(expect);
+    fprintf(stderr, "# %u dropped\n", s.dropped - dropped);
+    }
+  }
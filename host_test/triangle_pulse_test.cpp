@@ -0,0 +1,65 @@
+// TrianglePulse and LinearSamples over 50 (simulated) days, across the millis() rollover: no drift.
+// Every value is checked against the exact (float) curve at (now - the first start) % wavelength,
+// so a start that crept by even a msec over the 50 days would show.
+// A long is 64 bits here, so we start 25 days before 2^64 (same arithmetic as 2^32 on the chip).
+
+#include "TrianglePulse.h"
+#include "LinearSamples.h"
+#include "host_test.h"
+
+const unsigned long Day = 24UL * 60 * 60 * 1000;
+const unsigned long T0 = 0UL - 25 * Day;
+
+double worst_tri, worst_lin_up, worst_lin_down;
+unsigned long checked;
+
+// the exact curves
+double triangle(double ph, double rise, double wl, double lo, double hi) {
+  return ph < rise ? lo + (hi - lo) * ph / rise : hi - (hi - lo) * (ph - rise) / (wl - rise);
+  }
+double linear(double ph, double wl, double lo, double hi) { return lo + (hi - lo) * ph / wl; }
+
+void check(TrianglePulse &tri, LinearSamples &up, LinearSamples &down) {
+  unsigned long since = mock_ms - T0; // rollover safe
+
+  tri.next();
+  double err = fabs(tri.value - triangle(since % 1237, tri.rise_ms, 1237, 10, 250));
+  if (err > worst_tri) worst_tri = err;
+
+  up.next();
+  err = fabs(up.value - linear(since % 3001, 3001, 0, 255));
+  if (err > worst_lin_up) worst_lin_up = err;
+
+  down.next();
+  err = fabs(down.value - linear(since % 997, 997, 200, 5));
+  if (err > worst_lin_down) worst_lin_down = err;
+
+  checked++;
+  }
+
+int main() {
+  mock_ms = T0;
+  TrianglePulse tri(10, 250, 1237, 0.3);
+  LinearSamples up(0, 255, 3001), down(200, 5, 997);
+
+  // every msec for a while, then a look every 9973 msec (a prime, so all the phases come up),
+  // every msec again around the rollover and at the end
+  unsigned long t = 0;
+  for (; t < 20000; t++) { mock_ms = T0 + t; check(tri, up, down); }
+  for (; t < 25 * Day - 20000; t += 9973) { mock_ms = T0 + t; check(tri, up, down); }
+  for (t = 25 * Day - 20000; t < 25 * Day + 20000; t++) { mock_ms = T0 + t; check(tri, up, down); }
+  CHECK( mock_ms < T0 ); // we did roll over
+  for (; t < 50 * Day - 20000; t += 9973) { mock_ms = T0 + t; check(tri, up, down); }
+  for (t = 50 * Day - 20000; t <= 50 * Day; t++) { mock_ms = T0 + t; check(tri, up, down); }
+
+  printf("%lu checked over 50 days, worst: triangle %.3f, linear up %.3f, linear down %.3f counts\n",
+    checked, worst_tri, worst_lin_up, worst_lin_down);
+  // rounded to the nearest count (plus a bit for the Q16.16 slope)
+  CHECK( worst_tri < 0.55 );
+  CHECK( worst_lin_up < 0.55 );
+  CHECK( worst_lin_down < 0.55 );
+  // and the starts moved by whole waves only
+  CHECK( mock_ms - tri.start == (50 * Day) % 1237 );
+  CHECK( mock_ms - up.start == (50 * Day) % 3001 );
+  CHECK( mock_ms - down.start == (50 * Day) % 997 );
+  }
@@ -0,0 +1,42 @@
+// Waveform::next() (the sine table) vs the same curve from cos()/cosf(), per sample.
+// One sample per simulated msec, a 1000 msec wave. Checks they agree too (waveform_test has how closely).
+
+#include "Waveform.h"
+#include "host_test.h"
+
+const unsigned long Samples = 50000000;
+const unsigned long Wavelength = 1000;
+
+template <typename F>
+double per_sample(F sample) {
+  double start = host_ns();
+  for (unsigned long ms = 0; ms < Samples; ms++) {
+    mock_ms = ms;
+    keep( sample() );
+    }
+  return (host_ns() - start) / Samples;
+  }
+
+// the exact curve: one cycle starting at the bottom, 0..255..0
+byte by_cos(unsigned long ms) { return 127.5 - 127.5 * cos( 2 * M_PI * (ms % Wavelength) / Wavelength ) + 0.5; }
+byte by_cosf(unsigned long ms) { return 127.5f - 127.5f * cosf( 2 * (float) M_PI * (ms % Wavelength) / Wavelength ) + 0.5f; }
+
+int main() {
+  mock_ms = 0;
+  Waveform sine(waveform_sine, Wavelength);
+  for (; mock_ms < Wavelength; mock_ms++) {
+    sine.next();
+    CHECK( abs(sine.value - by_cos(mock_ms)) <= 2 );
+    }
+
+  mock_ms = 0;
+  sine.restart();
+  double lut = per_sample( [&]() { sine.next(); return sine.value; } );
+  double dbl = per_sample( []() { return by_cos(mock_ms); } );
+  double flt = per_sample( []() { return by_cosf(mock_ms); } );
+
+  printf("ns per sample, %lu samples\n", Samples);
+  printf("  Waveform::next()\t%.1f\n", lut);
+  printf("  cos()\t%.1f\n", dbl);
+  printf("  cosf()\t%.1f\n", flt);
+  }
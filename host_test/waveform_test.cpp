@@ -0,0 +1,78 @@
+// Waveform.h's curves vs the exact functions they are tables of: within 1.5 counts at every phase.
+// And through Waveform/Ramp (the reciprocal phase, waveform_scale), and the ADSR stages.
+
+#include "Waveform.h"
+#include "host_test.h"
+
+struct Curve { const char *name; const byte *table; double (*exact)(double x); };
+
+double sine(double x) { return 0.5 - 0.5 * cos(2 * M_PI * x); }
+const Curve curves[] = {
+  { "sine", waveform_sine, sine },
+  { "breathe", waveform_breathe, [](double x) { return pow(sine(x), 2.2); } },
+  { "ease_in", waveform_ease_in, [](double x) { return x * x; } },
+  { "ease_out", waveform_ease_out, [](double x) { return 1 - (1 - x) * (1 - x); } },
+  { "ease_in_out", waveform_ease_in_out, [](double x) { return 0.5 - 0.5 * cos(M_PI * x); } },
+  { "exponential", waveform_exponential, [](double x) { return (pow(2, 8 * x) - 1) / 255; } },
+  { "linear", NULL, [](double x) { return x; } },
+  };
+
+int main() {
+  for (const Curve &c : curves) {
+    double worst = 0;
+    for (long phase = 0; phase < 65536; phase++) {
+      double err = fabs( waveform_at(c.table, phase) - 255 * c.exact(phase / 65536.0) );
+      if (err > worst) worst = err;
+      }
+    printf("%s: worst %.2f counts\n", c.name, worst);
+    CHECK( worst <= 1.5 );
+    }
+
+  // the sine through Waveform::next(): the phase from the reciprocal, a wavelength that isn't a power of 2
+  mock_ms = 0;
+  Waveform wave(waveform_sine, 1000);
+  double worst = 0;
+  for (; mock_ms < 3000; mock_ms++) {
+    CHECK( wave.next() == (mock_ms % 1000 != 0 || mock_ms == 0) ); // false as each wave finishes
+    double err = fabs( wave.value - 255 * sine( (mock_ms % 1000) / 1000.0 ) );
+    if (err > worst) worst = err;
+    }
+  printf("Waveform(sine, 1000): worst %.2f counts\n", worst);
+  CHECK( worst <= 1.5 );
+
+  // scaled: stays in lo..hi, and gets to both (the top within a count, 777 has no msec right at the peak)
+  mock_ms = 0;
+  Waveform narrow(waveform_sine, 777, 50, 200);
+  byte lo = 255, hi = 0;
+  for (; mock_ms < 777; mock_ms++) {
+    narrow.next();
+    if (narrow.value < lo) lo = narrow.value;
+    if (narrow.value > hi) hi = narrow.value;
+    }
+  CHECK( lo == 50 && hi >= 199 && hi <= 200 );
+
+  // a Ramp down, then chained: ends exactly on its "to"
+  mock_ms = 0;
+  Ramp ramp(waveform_ease_in_out, 500, 200, 20);
+  while (ramp.next()) {
+    CHECK( ramp.value <= 200 && ramp.value >= 20 );
+    mock_ms += 7;
+    }
+  CHECK( ramp.value == 20 );
+  ramp.then(100, 300); // from when it ended, not from now
+  mock_ms = 500 + 300;
+  CHECK( !ramp.next() && ramp.value == 100 );
+
+  // ADSR: attack to the peak, decay to sustain, hold, release to 0
+  mock_ms = 0;
+  ADSR env(100, 200, 120, 300);
+  CHECK( !env.next() && env.value == 0 );
+  env.on();
+  mock_ms = 50; CHECK( env.next() && env.stage == ADSR::Attack );
+  mock_ms = 100; CHECK( env.next() && env.stage == ADSR::Decay && env.value == 255 );
+  mock_ms = 300; CHECK( env.next() && env.stage == ADSR::Sustain && env.value == 120 );
+  mock_ms = 1000; CHECK( env.next() && env.value == 120 );
+  env.off();
+  mock_ms = 1150; CHECK( env.next() && env.stage == ADSR::Release && env.value < 120 && env.value > 0 );
+  mock_ms = 1300; CHECK( !env.next() && env.value == 0 );
+  }
@@ -10,6 +10,9 @@
 #include <Adafruit_NeoPixel.h>
 #include "PWM_Pins.h"
 #include "RGB.h"
+#ifdef TELEMETRY_TX
+#include "Telemetry.h"
+#endif
 
 class PWM_NeoPixel : public PWM_Pins {
     // interface for PWM's on a neopixel "Strip"
@@ -62,21 +65,35 @@ class PWM_NeoPixel : public PWM_Pins {
     void decompose_rgb(uint32_t rgb, uint8_t &r, uint8_t &g, uint8_t &b ) {
       // update r,g,b as the 8bit parts of the int rgb
       r = (rgb & 0xFF0000) >> 16;
-      g = (rgb & 0x00F00) >> 8;
+      g = (rgb & 0x00FF00) >> 8;
       b = rgb & 0x0000FF;
     }
 
     void print() {
       // print the current values, each as r,g,b, fixed up to graph
+      // With TELEMETRY_TX (see Telemetry.h), sends a TelemetryNeoPixel record instead, the plain 0..255 values
+#ifdef TELEMETRY_TX
+      int16_t values[NeoNumPixels * 3];
+#endif
       for(int i=0; i<NeoNumPixels; i++) {
         uint32_t rgb_int = neo.getPixelColor( i );
         RGB<uint8_t> rgb_parts;
         decompose_rgb( rgb_int, rgb_parts.red, rgb_parts.green, rgb_parts.blue );
+#ifdef TELEMETRY_TX
+        values[i * 3] = rgb_parts.red;
+        values[i * 3 + 1] = rgb_parts.green;
+        values[i * 3 + 2] = rgb_parts.blue;
+#else
         Serial << _FLOAT( rgb_parts.red /256.0 + 0 + i * 4, 2 );
         Serial << _FLOAT( rgb_parts.green /256.0 + 1 + i * 4, 2 );
-        Serial << _FLOAT( rgb_parts.green /256.0 + 2 + i * 4, 2 );
+        Serial << _FLOAT( rgb_parts.blue /256.0 + 2 + i * 4, 2 );
+#endif
       }
+#ifdef TELEMETRY_TX
+      Telemetry::record_array(TelemetryNeoPixel, values, NeoNumPixels * 3);
+#else
       Serial << endl;
+#endif
     }
 
     void demo() {
@@ -0,0 +1 @@
+../Telemetry.h
\ No newline at end of file
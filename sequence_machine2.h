@@ -46,6 +46,12 @@
     // Don't do anything that would take too much time,
     // because that will prevent getting to the next step of the sequences
   }
+
+  // The FunctionPointer lists take 2 bytes of RAM per step (on AVR). To keep them in flash instead:
+  const FunctionPointer sequence4[] PROGMEM = { ... };
+  ...
+    run_machine_P(sequence4); // and declare_machine_P, declare_machine_debug_P, machine_P
+  // Or see Sequence<> below, where the list is a type, so takes no RAM at all.
 */
 /*
   Writing your own "step" functions:
@@ -72,6 +78,34 @@
     }
     // that's it. You can use it in a sequence like: [ ... count_down<10>, ...
 */
+/*
+  Typed steps: Sequence<step, step, ...>
+  The "machine" above gives every step 8 bytes (and memset's them each step), plus user_data, which you cast.
+  Instead, each step can be a type that says what state it needs:
+
+  Sequence< DigitalWrite<led1_pin, HIGH>, WaitFor<200>, DigitalWrite<led1_pin, LOW>, WaitFor<200> > blink;
+  ...
+  void loop() { blink.run(); } // or .run_once() like machine
+
+  The Sequence holds a union of the steps' State's, so it is only as big as the biggest (plus 2 bytes).
+  Steps can be combined: Parallel<step, step...>, Race<step, step...>, Repeat<n, step>, and a Sequence<...> is a step.
+  Only the current step's State is initialized (to State(), i.e. zeros), when we get to that step.
+  The list of steps is the type, so it takes no RAM. run() jumps to the current step through a table in flash.
+  You can name it: typedef Sequence< ... > Blink; Blink blink1, blink2;
+
+  Writing your own typed step:
+  template<int initial_argument>
+  struct CountDown {
+    struct State { unsigned long count; }; // must be "plain" (no constructors etc.). Use SequenceNoState if none.
+    static boolean step(State &s) { // same as before: return true when done
+      if (s.count == 0) s.count = initial_argument;
+      ...
+      }
+    };
+
+  Step<fn, bytes> runs an old style step function, with "bytes" of state (the default 0 is ok for ones that don't use it):
+    Sequence< Step< &set_rand<&r, 100, 1000> >, Step< &count_down<10>, 4 > > ...
+*/
 
 #include <Arduino.h>
 #define debugm(msg)
@@ -95,11 +129,19 @@ typedef boolean(*FunctionPointer)(byte []); // preserve our sanity
   sequence ## _machine.run();
 #define run_machine_debug(sequence) declare_machine_debug(sequence); \
   sequence ## _machine.run();
+// Same, for a "const FunctionPointer sequence[] PROGMEM"
+#define declare_machine_P(sequence) static machine_P sequence ## _machine = {sequence, arraysize(sequence) };
+#define declare_machine_debug_P(sequence) static machine_P sequence ## _machine = {sequence, arraysize(sequence), true, #sequence };
+#define run_machine_P(sequence) declare_machine_P(sequence); \
+  sequence ## _machine.run();
+#define run_machine_debug_P(sequence) declare_machine_debug_P(sequence); \
+  sequence ## _machine.run();
   
-struct machine {
+template<boolean in_progmem>
+struct _sequence_machine {
   public:
   // keep track of how far we are in the sequence
-  FunctionPointer *sequence;
+  const FunctionPointer *sequence; // in PROGMEM for machine_P
   unsigned len;  // need length, from arraysize(), implies literal-time sequences only
   boolean debug;  // optional, turn on serial debug messages
   char *name; // my name, for debugging
@@ -108,9 +150,11 @@ struct machine {
   byte state[8]; // per step, gets reset, see "Writing your own..." above
   unsigned long user_data; // per machine, we don't mess with this. use it as (castyours) &state[8]
 
+  FunctionPointer step(int i) { return in_progmem ? (FunctionPointer) pgm_read_ptr( &sequence[i] ) : sequence[i]; }
+
   // This runs the machine
   void run() {
-    if ((*sequence[idx])(state)) { // call the step, move on if it finished (==true)
+    if ((*step(idx))(state)) { // call the step, move on if it finished (==true)
         if (debug) {
             Serial.print(name); Serial.print(" ");
             Serial.print(millis()); Serial.print(": "); Serial.print("Did "); Serial.print(idx); Serial.println(" ");
@@ -133,15 +177,15 @@ struct machine {
 
 
 };
+typedef _sequence_machine<false> machine;
+typedef _sequence_machine<true> machine_P; // the sequence is in PROGMEM
 
 // Use this instead of delay.
 // Also, an example of a function for use in the sequences.
 // Convenient to use like: void xyz() { static unsigned long w; wait_for(&w, 2000) }
 // "wait" is milliseconds.
-boolean wait_for(byte *state, int wait) { return wait_for(state, (unsigned long) wait); }
-boolean wait_for(unsigned long &state, int wait) { return wait_for((byte *)&state, (unsigned long) wait); }
-boolean wait_for(byte *state, long unsigned int wait) {
-  unsigned long *timer = (unsigned long *)state;
+boolean wait_for(unsigned long &state, long unsigned int wait) {
+  unsigned long *timer = &state;
   if (*timer == 0) {
       // Serial.print(millis()); Serial.print(": "); Serial.print("Start delay "); Serial.println(wait); 
       *timer = wait + millis();
@@ -156,6 +200,9 @@ boolean wait_for(byte *state, long unsigned int wait) {
     return false;
   } 
 }
+boolean wait_for(unsigned long &state, int wait) { return wait_for(state, (unsigned long) wait); }
+boolean wait_for(byte *state, long unsigned int wait) { return wait_for(*(unsigned long *)state, wait); }
+boolean wait_for(byte *state, int wait) { return wait_for(state, (unsigned long) wait); }
 
 // I don't think any of the <T *v> templates work
 
@@ -239,13 +286,16 @@ void triangle_analog_write(int value, byte* userdata, byte bytes[]) {
   analogWrite(*pin, value);
   }
 
-void triangle(byte bytes[], TriangleFunction fn, int min, int max, int up_inc, int down_inc, int step_delay, boolean once, byte *userdata=NULL) {
+struct TriangleState {
+  long value; // 0 is not running
+  unsigned long waiter;
+  };
+
+void triangle(TriangleState &t, TriangleFunction fn, int min, int max, int up_inc, int down_inc, int step_delay, boolean once, byte *userdata=NULL, byte bytes[]=NULL) {
   // Set state to 1 to start running. We will set state to 0 when we want to stop!
-  // we use 8 bytes of state.
-  long *state = (long*) &(bytes[0]);
-  byte *waiter =  &(bytes[4]);
+  long *state = &t.value;
 
-  if (step_delay && ! wait_for(waiter, step_delay) ) { 
+  if (step_delay && ! wait_for(t.waiter, step_delay) ) { 
     if (*state == 0) { *state = 1; }
     return; 
     }
@@ -257,7 +307,7 @@ void triangle(byte bytes[], TriangleFunction fn, int min, int max, int up_inc, i
     if (*state >= -min) {
       if (once) {
         debugm("once'd\n");
-        fn(0, bytes, userdata); // was analogWrite(pin, 0);
+        fn(0, userdata, bytes); // was analogWrite(pin, 0);
         *state = 0; // mark not running
         return;
         // return true; // done
@@ -286,11 +336,20 @@ void triangle(byte bytes[], TriangleFunction fn, int min, int max, int up_inc, i
   // return false;
   }
 
+void triangle(byte bytes[], TriangleFunction fn, int min, int max, int up_inc, int down_inc, int step_delay, boolean once, byte *userdata=NULL) {
+  // we use 8 bytes of state.
+  triangle(*(TriangleState *) bytes, fn, min, max, up_inc, down_inc, step_delay, once, userdata, bytes);
+  }
+
 void triangle(byte bytes[], int pin, int min, int max, int up_inc, int down_inc, int step_delay, boolean once) {
   // stash the pin after the trianglestate
   triangle(bytes, &triangle_analog_write, min, max, up_inc, down_inc, step_delay, once, (byte*) &pin);
   }
 
+void triangle(TriangleState &t, int pin, int min, int max, int up_inc, int down_inc, int step_delay, boolean once) {
+  triangle(t, &triangle_analog_write, min, max, up_inc, down_inc, step_delay, once, (byte*) &pin);
+  }
+
 // This one is constants for constant values
 template <int pin, int min, int max, int up_inc, int down_inc, int step_delay>
 boolean triangle(byte *bytes) {
@@ -322,6 +381,175 @@ boolean triangle(byte *bytes) {
   return *state == 0; // 0 means done
   }
 
+// Typed steps, for Sequence<...>. See "Typed steps" at the top.
+
+struct SequenceNoState {};
+
+template<unsigned long wait>
+struct WaitFor {
+  struct State { unsigned long timer; };
+  static boolean step(State &s) { return wait_for(s.timer, wait); }
+  };
+
+template <int pin,  uint8_t hilo> struct DigitalWrite {
+  typedef SequenceNoState State;
+  static boolean step(State &s) { digitalWrite(pin, hilo); return true; }
+  };
+
+template <int pin,  uint8_t pwm> struct AnalogWrite {
+  typedef SequenceNoState State;
+  static boolean step(State &s) { analogWrite(pin, pwm); return true; }
+  };
+
+template<long *current_r, int from, int to>
+struct SetRand {
+  typedef SequenceNoState State;
+  static boolean step(State &s) { *current_r = random(from,to); return true; }
+  };
+
+// like with_rand<>: a random from..to for the ul_fn (e.g. wait_for)
+template<boolean (*ul_fn)(unsigned long &, long unsigned), int from, int to>
+struct WithRand {
+  struct State { unsigned long count; unsigned long current_r; };
+  static boolean step(State &s) {
+    if (s.count == 0) s.current_r = random(from,to);
+    return ul_fn(s.count, s.current_r);
+    }
+  };
+
+template <int pin, int min, int max, int up_inc, int down_inc, int step_delay>
+struct Triangle {
+  typedef TriangleState State;
+  static boolean step(State &s) {
+    triangle(s, pin, min, max, up_inc, down_inc, step_delay, true);
+    return s.value == 0; // 0 means done
+    }
+  };
+
+template <TriangleFunction fn, TriangleSettings &ts>
+struct TriangleWith {
+  typedef TriangleState State;
+  static boolean step(State &s) {
+    triangle(s, fn, ts.min, ts.max, ts.up_inc, ts.down_inc, ts.step_delay, true);
+    return s.value == 0;
+    }
+  };
+
+// an old style step function, with its bytes of state
+template<FunctionPointer fn, unsigned size=0>
+struct Step {
+  struct State { byte bytes[size ? size : 1]; };
+  static boolean step(State &s) { return (*fn)(s.bytes); }
+  };
+
+// A union of the steps' State's
+template<typename... Steps> union _SequenceStates;
+template<> union _SequenceStates<> {};
+template<typename S, typename... Rest> union _SequenceStates<S, Rest...> {
+  typename S::State head;
+  _SequenceStates<Rest...> tail;
+  };
+
+// runs step S, with the union as its State (they all start at the start of the union)
+template<typename S> boolean _sequence_step(void *state, boolean entering) {
+  typename S::State &s = *(typename S::State *) state;
+  if (entering) s = typename S::State(); // now the active one
+  return S::step(s);
+  }
+
+template<typename... Steps>
+struct _SequenceRun { // all zeros is "at the start", so it can be a step's State
+  byte idx; // how far
+  boolean in_step; // false means idx is a new step
+  _SequenceStates<Steps...> state;
+
+  // Runs the current step, moves on if it finished. True if that was the last step.
+  boolean advance() {
+    // a jump table, in flash
+    typedef boolean (*StepFn)(void *state, boolean entering);
+    static const StepFn steps[] PROGMEM = { &_sequence_step<Steps>... };
+    in_step = ! ( (StepFn) pgm_read_ptr( &steps[idx] ) )(&state, ! in_step);
+    if (in_step) return false;
+    if (++idx < sizeof...(Steps)) return false;
+    idx = 0;  // start over at 0
+    return true;
+    }
+  };
+
+template<typename... Steps>
+class Sequence : public _SequenceRun<Steps...> {
+  public:
+  static const byte len = sizeof...(Steps);
+
+  Sequence() : _SequenceRun<Steps...>() {}
+
+  // This runs the current step, and moves on if it finished
+  void run() { this->advance(); }
+
+  // this runs it all the way through once, do .restart() if you stop early
+  boolean run_once() {
+    return ! this->advance(); // still running
+    }
+
+  void restart() { this->idx = 0; this->in_step = false; }
+
+  // A Sequence can be a step in another: once through, then it's done
+  typedef _SequenceRun<Steps...> State;
+  static boolean step(State &s) { return s.advance(); }
+  };
+
+// Step combinators. Each "step" can be any step type, including a Sequence<...>.
+
+// Run the steps at the same time (each once per run()), done when all are done (i.e. fork & join).
+//   Sequence< Parallel< Sequence<fade up 1, ...>, Sequence<blink 2, ...> >, WaitFor<500>, ... >
+template<typename... Steps> struct _ParallelStates;
+template<> struct _ParallelStates<> {
+  boolean step_all() { return true; }
+  boolean step_any() { return false; }
+  };
+template<typename S, typename... Rest> struct _ParallelStates<S, Rest...> {
+  typename S::State head;
+  boolean head_done;
+  _ParallelStates<Rest...> tail;
+
+  boolean step_all() {
+    if (!head_done) head_done = S::step(head);
+    return tail.step_all() && head_done;
+    }
+  boolean step_any() {
+    boolean done = S::step(head);
+    return tail.step_any() || done;
+    }
+  };
+
+template<typename... Steps>
+struct Parallel {
+  typedef _ParallelStates<Steps...> State;
+  static boolean step(State &s) { return s.step_all(); }
+  };
+
+// Same, but done when the first one is done (the rest are just dropped)
+template<typename... Steps>
+struct Race {
+  typedef _ParallelStates<Steps...> State;
+  static boolean step(State &s) { return s.step_any(); }
+  };
+
+// The step, n times
+template<unsigned int n, typename S>
+struct Repeat {
+  struct State {
+    unsigned int count;
+    typename S::State s;
+    };
+  static boolean step(State &s) {
+    if (! S::step(s.s)) return false;
+    if (++s.count >= n) return true;
+    s.s = typename S::State(); // fresh for the next time
+    return false;
+    }
+  };
+
 /* ****************************
 // This function makes the sequence wait till the button goes HIGH, or 5 seconds, whichever is first
 boolean wait_for_button() {
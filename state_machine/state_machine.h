@@ -33,6 +33,66 @@
 
 */
 
+/* Table engine
+
+    #define STATE_MACHINE_TABLE // before the #include
+    #include "state_machine.h"
+
+    Same STATE/GOTOWHEN/END_STATE, SIMPLESTATE, STATEMACHINE, RESTART, and action functions.
+    But each STATE block becomes a row in flash (PROGMEM): the action, the GOTOWHEN predicates+targets, and the next state.
+    StateMachine::run() is then one loop over the current row, instead of calling through the state's function,
+    which calls one_step(), which calls each gotowhen<> function.
+    No recursion guard. A machine's .current is a pointer to the row.
+    _statename_xtion is still a function (so the usual forward references work), it returns the row,
+    and is only called when we change states.
+*/
+
+/* Superstates (hierarchical states)
+
+    Transitions that several states share, like "any of these: on E-stop go to safe",
+    go in a SUPERSTATE instead of being copied into each STATE. They are checked once per pass,
+    after the current state's own GOTOWHEN's.
+
+    SUPERSTATE(running, motor_on) // name, and the first state when you go to "running"
+      GOTOWHEN(estop, safe)
+      END_SUPERSTATE
+    STATEIN(running, motor_on, coast)
+      GOTOWHEN(too_fast, coast)
+      END_STATE
+    SIMPLESTATEIN(running, coast, motor_on)
+    SIMPLESTATE(safe, ...)
+      ... GOTOWHEN(estop_cleared, running_history) // back to whichever state we were in
+
+    SUPERSTATEAS(name, action, first_state): action gets SM_Start when we enter the superstate,
+      SM_Finish when we leave it (return value ignored). Moving between its own states doesn't leave it.
+    SUPERSTATEIN(parent, name, first_state), SUPERSTATEASIN(parent, name, action, first_state): nested.
+    STATEIN, STATEASIN, SIMPLESTATEIN, SIMPLESTATEASIN: like STATE etc. with the superstate first.
+    The order is: old state SM_Finish, superstates we leave SM_Finish (inner first),
+      superstates we enter SM_Start (outer first), new state SM_Start.
+      (The superstate part happens at the start of the new state's first run).
+    name_history: (shallow) history, the last state that ran directly in "name", else its first_state.
+      Shared by all machines that use "name", like everymillis<>.
+    Both engines (STATE_MACHINE_TABLE or not).
+*/
+
+/* Tracing
+
+    DEBUG==1 prints as it goes, which is slow enough to change the timing.
+    Instead, record each state change into a ring buffer in RAM, and dump it later:
+
+    #define SM_TRACE 32 // records, a power of 2. Before the #include
+    #include "state_machine.h"
+    ...
+    if (Serial.read() == 't') StateMachineTrace::dump(); // or when something goes wrong
+
+    Each record is: millis since the previous record, the machine, from-state, to-state,
+      and the phase "from" was in: SM_Start (it left on its first run), SM_Running, or SM_Finish (a restart()).
+      That's 9 bytes on AVR.
+    The dump is hex addresses, sm-trace-decode (next to this file) turns it back into names with avr-nm:
+      state_machine/sm-trace-decode yoursketch.ino.elf < the-dump.txt
+    (Arduino IDE: Sketch/Export compiled Binary for the .elf)
+*/
+
 #ifndef DEBUG
 #define DEBUG 0
 #endif
@@ -48,6 +108,228 @@ typedef boolean (*ActionFnPtr)(StateMachine& sm); // your action functions
 
 enum StateMachinePhase { SM_Start, SM_Running, SM_Finish };
 
+typedef boolean (*BooleanFnPtr)();
+
+struct SuperState; // a SUPERSTATE
+typedef const SuperState *(*SuperStateFnPtr)(); // _name_super gives it
+
+// An event a machine can wait for (see sm_wait_event). Set it to true from anywhere, even an interrupt.
+typedef volatile boolean SMEvent;
+
+struct StateMachineWait {
+    // What a machine is waiting for, so StateMachineScheduler doesn't have to run it till then.
+    // Some combination of: a deadline, and an SMEvent or a pin level.
+    // A plain machine.run() ignores this.
+    enum { WaitDeadline = 1, WaitEvent = 2, WaitPin = 4 };
+
+    unsigned long wake_at; // millis()
+    union {
+      SMEvent *event;
+      struct { byte pin; byte level; } pin;
+      } wait_for;
+    byte waiting = 0; // Wait... bits
+
+    void park_until(unsigned long at) { wake_at = at; waiting = WaitDeadline; }
+    void park_for_event(SMEvent *event) { wait_for.event = event; waiting = WaitEvent; }
+    void park_for_pin(byte pin, byte level) { wait_for.pin.pin = pin; wait_for.pin.level = level; waiting = WaitPin; }
+    // a timeout for the event/pin
+    void park_until_or(unsigned long at) { wake_at = at; waiting |= WaitDeadline; }
+    void unpark() { waiting = 0; }
+
+    // still parked as of "now"? (unparks if not)
+    boolean is_parked(unsigned long now) {
+      if (!waiting) return false;
+      if ( ( (waiting & WaitDeadline) && (long)(now - wake_at) >= 0 )
+        || ( (waiting & WaitEvent) && *wait_for.event )
+        || ( (waiting & WaitPin) && digitalRead(wait_for.pin.pin) == wait_for.pin.level )
+        ) {
+        waiting = 0;
+        return false;
+        }
+      return true;
+      }
+    };
+
+#ifdef SM_TRACE
+
+struct StateMachineTraceRecord {
+    uint16_t dt; // millis since the previous record, 0xFFFF means at least
+    const void *machine;
+    const void *from;
+    const void *to;
+    byte phase; // that "from" was in
+    };
+
+class StateMachineTrace {
+    public:
+    static_assert( (SM_TRACE & (SM_TRACE - 1)) == 0, "SM_TRACE must be a power of 2");
+
+    struct State {
+      StateMachineTraceRecord records[SM_TRACE];
+      unsigned int next;
+      boolean wrapped;
+      unsigned long last_ms; // of the most recent record
+      };
+    static State &state() { static State s; return s; }
+
+    static void record(const void *machine, const void *from, const void *to, byte phase) {
+      State &s = state();
+      unsigned long now = millis();
+      unsigned long dt = now - s.last_ms;
+      s.last_ms = now;
+
+      StateMachineTraceRecord &r = s.records[s.next];
+      r.dt = dt > 0xFFFF ? 0xFFFF : dt;
+      r.machine = machine;
+      r.from = from;
+      r.to = to;
+      r.phase = phase;
+
+      s.next = (s.next + 1) & (SM_TRACE - 1);
+      if (s.next == 0) s.wrapped = true;
+      }
+
+    static void clear() { State &s = state(); s.next = 0; s.wrapped = false; }
+
+    static void dump(Print &out = Serial) {
+      // "# sm_trace" count last_ms, then a line per record (oldest first): dt machine from to phase, tab separated hex
+      State &s = state();
+      unsigned int count = s.wrapped ? SM_TRACE : s.next;
+      out.print(F("# sm_trace ")); out.print(count); out.print(F(" ")); out.println(s.last_ms);
+      for (unsigned int i = s.wrapped ? s.next : 0, n = 0; n < count; i = (i + 1) & (SM_TRACE - 1), n++) {
+        StateMachineTraceRecord &r = s.records[i];
+        out.print(r.dt, HEX); out.print(F("\t"));
+        out.print((unsigned long) r.machine, HEX); out.print(F("\t"));
+        out.print((unsigned long) r.from, HEX); out.print(F("\t"));
+        out.print((unsigned long) r.to, HEX); out.print(F("\t"));
+        out.println(r.phase, HEX);
+        }
+      out.println(F("# end"));
+      }
+    };
+
+#define SM_TRACE_RECORD(machine, from, to, phase) StateMachineTrace::record( (machine), (const void *)(from), (const void *)(to), (phase) )
+#else
+#define SM_TRACE_RECORD(machine, from, to, phase) ((void)(machine), (void)(from), (void)(to), (void)(phase)) // no unused warnings
+#endif
+
+#ifdef STATE_MACHINE_TABLE
+
+struct StateRow;
+typedef const StateRow *(*StateXtionFnPtr)(); // _statename_xtion gives the row
+struct StateGoto { // a GOTOWHEN
+  BooleanFnPtr pred; // NULL ends the list
+  StateXtionFnPtr next_state;
+  };
+struct StateRow { // a STATE, in PROGMEM
+  ActionFnPtr action;
+  StateXtionFnPtr next_state; // when the action is done
+  const StateGoto *gotos;
+  SuperStateFnPtr parent; // NULL if not in a SUPERSTATE
+  };
+typedef const StateRow *StateRef; // what .current is
+struct SuperState { // a SUPERSTATE, in PROGMEM
+  ActionFnPtr action; // or NULL
+  SuperStateFnPtr parent;
+  const StateGoto *gotos;
+  StateRef *history; // in RAM
+  };
+#define SM_READ_PTR(type, p) ( (type) pgm_read_ptr( &(p) ) )
+
+struct StateMachine;
+void _sm_start_state(StateMachine &sm, SuperStateFnPtr parent, StateRef self);
+void _sm_change_super(StateMachine &sm, const SuperState *to);
+inline const SuperState *_sm_parent_of(const SuperState *s);
+
+struct StateMachine : public StateMachineWait {
+    // subclass for your own user-data
+    StateMachinePhase phase;
+    const StateRow *current; // in PROGMEM
+    const SuperState *super = NULL; // innermost superstate we are in
+    // User data:
+    union {
+      unsigned long user_ulong;
+      int user_int;
+      };
+    // first state will be SM_Start
+    StateMachine(StateXtionFnPtr startstate) : phase(SM_Start), current( (*startstate)() ) {}
+
+    static ActionFnPtr action_of(const StateRow *row) { return (ActionFnPtr) pgm_read_ptr( &row->action ); }
+
+    void restart( StateXtionFnPtr xtion) {
+      // Finish current state
+      if (current && phase != SM_Finish) {
+        phase = SM_Finish;
+        (*action_of(current))(*this);
+        }
+      debugm("[");debugm(millis());debugm("] ");debugm(F("Restart to "));debugm((long)xtion);debugm(F("\n"));
+      const StateRow *was = current;
+      current = (*xtion)();
+      SM_TRACE_RECORD(this, was, current, SM_Finish);
+      phase = SM_Start;
+      unpark();
+      }
+
+    static boolean any_gotos(const StateGoto *g) { return pgm_read_ptr( &g->pred ) != NULL; }
+
+    static StateXtionFnPtr first_goto(const StateGoto *g) {
+        // the first GOTOWHEN whose predicate is true
+        for (; ; g++) {
+            BooleanFnPtr pred = (BooleanFnPtr) pgm_read_ptr( &g->pred );
+            if (!pred) return NULL;
+            if ( (*pred)() ) return (StateXtionFnPtr) pgm_read_ptr( &g->next_state );
+            }
+        }
+
+    boolean run() {
+        // someone might try to run us after we signaled "all done"
+        if (current == NULL) return false;
+
+        SuperStateFnPtr parent = (SuperStateFnPtr) pgm_read_ptr( &current->parent );
+        if (phase == SM_Start) _sm_start_state(*this, parent, current);
+
+        ActionFnPtr action = action_of(current);
+        boolean again = (*action)(*this);
+
+        // test preds at then end of every trial, then the superstates'
+        StateXtionFnPtr next_state = first_goto( (const StateGoto *) pgm_read_ptr( &current->gotos ) );
+        for (const SuperState *s = parent ? (*parent)() : NULL; !next_state && s; s = _sm_parent_of(s)) {
+            next_state = first_goto( (const StateGoto *) pgm_read_ptr( &s->gotos ) );
+            }
+        if (!next_state && again) {
+            phase = SM_Running;
+            if (waiting) {
+                // Can't park if there are GOTOWHEN's to check (ours or a superstate's), they have to run each pass
+                boolean gotos = any_gotos( (const StateGoto *) pgm_read_ptr( &current->gotos ) );
+                for (const SuperState *s = parent ? (*parent)() : NULL; !gotos && s; s = _sm_parent_of(s)) {
+                    gotos = any_gotos( (const StateGoto *) pgm_read_ptr( &s->gotos ) );
+                    }
+                if (gotos) unpark();
+                }
+            return true;
+            }
+        if (!next_state) next_state = (StateXtionFnPtr) pgm_read_ptr( &current->next_state );
+
+        StateMachinePhase was_phase = phase;
+        phase = SM_Finish;
+        (*action)(*this); // count on the wrappers to inhibit as necessary
+        const StateRow *was = current;
+        current = (*next_state)();
+        unpark(); // whatever the old state was waiting for
+        if (current != was) SM_TRACE_RECORD(this, was, current, was_phase);
+        // same as the function engine: going to yourself doesn't re-Start
+        phase = current == was ? SM_Running : SM_Start;
+        debugm("[");debugm(millis());debugm("] ");debugm((long)this);debugm(F(" ->"));debugm((long)current);debugm(F("\n"));
+
+        // a null means the state-machine wants to quit
+        if (current == NULL && super) _sm_change_super(*this, NULL);
+        return current != NULL;
+        }
+
+    };
+
+#else
+
 struct StateXtionFnPtr_; // declare functions returning this, they can get autocoerced to StateXtionFnPtr
 typedef StateXtionFnPtr_ (&StateXtionFnRef)(StateMachine& sm);
 typedef StateXtionFnPtr_ (*StateXtionFnPtr)(StateMachine& sm); // vars as this
@@ -56,11 +338,23 @@ struct StateXtionFnPtr_ {
     operator StateXtionFnPtr() { return p; } // auto-coerce a struct to StateXtionFnPtr
     StateXtionFnPtr p;
     };
+typedef StateXtionFnPtr StateRef; // what .current is
+struct SuperState { // a SUPERSTATE
+  ActionFnPtr action; // or NULL
+  SuperStateFnPtr parent;
+  const StateXtionFnPtr_ *gotos; // gotowhen<>'s
+  StateRef *history;
+  };
+#define SM_READ_PTR(type, p) ( (type) (p) )
+
+void _sm_change_super(StateMachine &sm, const SuperState *to);
+
 // the state of the machine
-struct StateMachine {
+struct StateMachine : public StateMachineWait {
     // subclass for your own user-data
     StateMachinePhase phase;
     StateXtionFnPtr current;
+    const SuperState *super = NULL; // innermost superstate we are in
     boolean recurse; // flag for re-entered
     // User data:
     union {
@@ -79,8 +373,10 @@ struct StateMachine {
         (*current)(*this);
         }
       debugm("[");debugm(millis());debugm("] ");debugm(F("Restart to "));debugm((long)&xtion);debugm(F("\n"));
+      SM_TRACE_RECORD(this, current, (StateXtionFnPtr) xtion, SM_Finish);
       current = xtion;
       phase = SM_Start;
+      unpark();
       }
 
     boolean run() {
@@ -96,11 +392,14 @@ struct StateMachine {
             }
 
         // The StateXtionFn (_realstatename_xtion) returns "what to do next", which may be stay
+        StateMachinePhase was_phase = phase;
         StateXtionFnPtr next_state = (*current)(*this);
 
         // debugm((long)this); debugm(" ->");debugm((long)next_state);debugm("\n"); 
         if (next_state != current) { 
             // debugm((long)this); debugm(" !->");debugm((long)next_state);debugm("\n"); 
+            SM_TRACE_RECORD(this, current, next_state, was_phase);
+            unpark(); // whatever the old state was waiting for
             }
         else { 
             phase = SM_Running;
@@ -111,16 +410,62 @@ struct StateMachine {
         current = next_state;
 
         // a null means the state-machine wants to quit
+        if (current == NULL && super) _sm_change_super(*this, NULL);
         recurse = false;
         return current != NULL;
         }
 
     };
 
-typedef boolean (*BooleanFnPtr)();
-
 template<BooleanFnPtr pred, StateXtionFnRef next_state> StateXtionFnPtr_ gotowhen(StateMachine &sm) { return (*pred)() ? next_state : NULL; }
 
+#endif
+
+inline const SuperState *_sm_parent_of(const SuperState *s) {
+    SuperStateFnPtr parent = SM_READ_PTR(SuperStateFnPtr, s->parent);
+    return parent ? (*parent)() : NULL;
+    }
+
+inline void _sm_super_action(StateMachine &sm, const SuperState *s, StateMachinePhase phase) {
+    ActionFnPtr action = SM_READ_PTR(ActionFnPtr, s->action);
+    if (!action) return;
+    StateMachinePhase was = sm.phase;
+    sm.phase = phase;
+    (*action)(sm);
+    sm.phase = was;
+    }
+
+inline void _sm_enter_supers(StateMachine &sm, const SuperState *s, const SuperState *stop) {
+    // outer first
+    if (s == stop) return;
+    _sm_enter_supers(sm, _sm_parent_of(s), stop);
+    _sm_super_action(sm, s, SM_Start);
+    }
+
+inline void _sm_change_super(StateMachine &sm, const SuperState *to) {
+    // Leave the superstates we aren't in anymore, enter the new ones
+    if (sm.super == to) return;
+
+    // innermost superstate that we are in, and "to" is in
+    const SuperState *common = sm.super;
+    for (; common; common = _sm_parent_of(common)) {
+      const SuperState *s = to;
+      while (s && s != common) s = _sm_parent_of(s);
+      if (s) break;
+      }
+
+    for (const SuperState *s = sm.super; s != common; s = _sm_parent_of(s)) _sm_super_action(sm, s, SM_Finish);
+    _sm_enter_supers(sm, to, common);
+    sm.super = to;
+    }
+
+inline void _sm_start_state(StateMachine &sm, SuperStateFnPtr parent, StateRef self) {
+    // at the SM_Start of each state
+    const SuperState *s = parent ? (*parent)() : NULL;
+    _sm_change_super(sm, s);
+    if (s) *SM_READ_PTR(StateRef *, s->history) = self;
+    }
+
 inline void debug_phase(StateMachine &sm) { 
   #if DEBUG==1
     static const char *phasename[] = { "SM_Start", "SM_Running", "SM_Finish" };
@@ -143,7 +488,48 @@ template<void fn()> inline boolean action_function_wrapper(StateMachine &sm) { i
 
 inline void debug_time() { debugm("[");debugm(millis());debugm("] "); }
 
-StateXtionFnPtr_ _NULL_xtion(StateMachine &sm) { return false; }
+#ifdef STATE_MACHINE_TABLE
+
+inline const StateRow *_NULL_xtion() { return NULL; }
+
+#define XTIONNAME(action) _##action##_xtion
+#define _STATEIN(parentfn, name, action, next_state) const StateRow *_##name##_xtion() { \
+    static constexpr ActionFnPtr _action = action_function_wrapper<action>; \
+    static constexpr StateXtionFnPtr next_state_xtion = _##next_state##_xtion; \
+    static constexpr SuperStateFnPtr _parent = parentfn; \
+    static const StateGoto gotos[] PROGMEM = {
+#define STATEAS(name, action, next_state) _STATEIN(NULL, name, action, next_state)
+#define STATE(action, next_state) STATEAS(action, action, next_state)
+#define GOTOWHEN(pred, action) { pred, _##action##_xtion },
+#define END_STATE { NULL, NULL } \
+        }; \
+    static const StateRow row PROGMEM = { _action, next_state_xtion, gotos, _parent }; \
+    return &row; \
+    }
+#define _SUPERSTATE(parentfn, name, actionfn, first_state) \
+    const SuperState *_##name##_super(); \
+    const StateRow *_##name##_xtion() { return _##first_state##_xtion(); } \
+    const StateRow *_##name##_history_xtion() { \
+        StateRef last = *SM_READ_PTR(StateRef *, _##name##_super()->history); \
+        return last ? last : _##first_state##_xtion(); \
+        } \
+    const SuperState *_##name##_super() { \
+        static constexpr ActionFnPtr _action = actionfn; \
+        static constexpr SuperStateFnPtr _parent = parentfn; \
+        static StateRef history; \
+        static const StateGoto gotos[] PROGMEM = {
+#define END_SUPERSTATE { NULL, NULL } \
+        }; \
+    static const SuperState super PROGMEM = { _action, _parent, gotos, &history }; \
+    return &super; \
+    }
+#define SIMPLESTATE(action, next_state) STATE(action, next_state) END_STATE
+#define SIMPLESTATEAS(name, action, next_state) STATEAS(name, action, next_state) END_STATE
+#define RESTART(machine, action) machine.restart(_##action##_xtion)
+
+#else
+
+StateXtionFnPtr_ _NULL_xtion(StateMachine &sm) { return (StateXtionFnPtr) NULL; }
 const StateXtionFnPtr_ NOPREDS[] = { (StateXtionFnPtr_) NULL };
 
 #define debug_state_msg(sm, action) if (DEBUG && sm.phase != SM_Running) {debug_time(); debugm((long)&sm);debugm(" ");debug_phase(sm); debugm(F(#action)); debugm(F(" ")); debugm((long) &_##action##_xtion); debugm(F("\n"));}
@@ -157,32 +543,48 @@ const StateXtionFnPtr_ NOPREDS[] = { (StateXtionFnPtr_) NULL };
   debug_state_msg(sm, name) \
   return one_step(sm, action_function_wrapper<action>, _##name##_xtion, NOPREDS, _##next_state##_xtion); \
   }
-#define STATEAS(name, action, next_state) StateXtionFnPtr_ _##name##_xtion(StateMachine &sm) { \
+#define _STATEIN(parentfn, name, action, next_state) StateXtionFnPtr_ _##name##_xtion(StateMachine &sm) { \
     static const ActionFnPtr _action = action_function_wrapper<action>; \
     static const StateXtionFnPtr next_state_xtion = _##next_state##_xtion; \
     static const StateXtionFnPtr self = _##name##_xtion; \
+    static const SuperStateFnPtr _parent = parentfn; \
     debug_state_msg(sm, name) \
     static const StateXtionFnPtr_ preds[] = {
-#define STATE(action, next_state) StateXtionFnPtr_ _##action##_xtion(StateMachine &sm) { \
-    static const ActionFnPtr _action = action_function_wrapper<action>; \
-    static const StateXtionFnPtr next_state_xtion = _##next_state##_xtion; \
-    static const StateXtionFnPtr self = _##action##_xtion; \
-    debug_state_msg(sm, action) \
-    static const StateXtionFnPtr_ preds[] = {
+#define STATEAS(name, action, next_state) _STATEIN(NULL, name, action, next_state)
+#define STATE(action, next_state) STATEAS(action, action, next_state)
 #define GOTOWHEN(pred, action) gotowhen<pred, _##action##_xtion>,
 #define END_STATE (StateXtionFnPtr_) NULL \
         }; \
     /* // template statxtinfntpr foraction(booleanfnpt action), and with statemachine &, and with phase */ \
-    return one_step(sm, _action, self, preds, next_state_xtion); \
+    return one_step(sm, _action, self, preds, next_state_xtion, _parent); \
+    }
+#define _SUPERSTATE(parentfn, name, actionfn, first_state) \
+    const SuperState *_##name##_super(); \
+    /* these two are only "current" till run() calls them: they make the real state current, and run it. */ \
+    /* So run() sees that state stay (or go), not a change from us to it (no trace record, no unpark()) */ \
+    StateXtionFnPtr_ _##name##_xtion(StateMachine &sm) { \
+        sm.current = _##first_state##_xtion; \
+        return (*sm.current)(sm); \
+        } \
+    StateXtionFnPtr_ _##name##_history_xtion(StateMachine &sm) { \
+        StateRef last = *_##name##_super()->history; \
+        sm.current = last ? last : _##first_state##_xtion; \
+        return (*sm.current)(sm); \
+        } \
+    const SuperState *_##name##_super() { \
+        static constexpr ActionFnPtr _action = actionfn; \
+        static constexpr SuperStateFnPtr _parent = parentfn; \
+        static StateRef history; \
+        static const StateXtionFnPtr_ preds[] = {
+#define END_SUPERSTATE (StateXtionFnPtr_) NULL \
+        }; \
+    static const SuperState super = { _action, _parent, preds, &history }; \
+    return &super; \
     }
 #define RESTART(machine, action) machine.restart(_##action##_xtion)
 
-StateXtionFnPtr_ one_step(StateMachine &sm, ActionFnPtr action, StateXtionFnPtr fromxtion, const StateXtionFnPtr_ preds[], StateXtionFnPtr nextxtion) {
-    // debugm("1st ");debugm((long)action);debugm(" ");
-    boolean again = (*action)(sm);
-    // debugm((long)fromxtion);debugm(F(" again? "));debugm(again);debugm("\n");
-
-    // test preds at then end of every trial
+StateXtionFnPtr first_goto(StateMachine &sm, const StateXtionFnPtr_ preds[]) {
+    // the first gotowhen<> that fires
     StateXtionFnPtr *pred = (StateXtionFnPtr*)preds; // head of list
     int i=0;
     // debugm("pred");
@@ -190,15 +592,42 @@ StateXtionFnPtr_ one_step(StateMachine &sm, ActionFnPtr action, StateXtionFnPtr
         StateXtionFnPtr rez = (**pred)(sm); // result is either false or a fnptr
         if (rez) { 
           debug_time();debugm(F("pred! "));debugm(i);debugm(F("\n"));
-          sm.phase = SM_Finish;
-          (*action)(sm); // count on the wrappers to inhibit as necessary
-          sm.phase = SM_Start;
           return rez; 
           };
         pred++; i++;
         }
+    return NULL;
+    }
+
+StateXtionFnPtr_ one_step(StateMachine &sm, ActionFnPtr action, StateXtionFnPtr fromxtion, const StateXtionFnPtr_ preds[], StateXtionFnPtr nextxtion, SuperStateFnPtr parent = NULL) {
+    // restart() finishing us: just the action, once
+    if (sm.phase == SM_Finish) { (*action)(sm); return NULL; }
+    if (sm.phase == SM_Start) _sm_start_state(sm, parent, fromxtion);
+
+    // debugm("1st ");debugm((long)action);debugm(" ");
+    boolean again = (*action)(sm);
+    // debugm((long)fromxtion);debugm(F(" again? "));debugm(again);debugm("\n");
+
+    // test preds at then end of every trial, then the superstates'
+    StateXtionFnPtr rez = first_goto(sm, preds);
+    for (const SuperState *s = parent ? (*parent)() : NULL; !rez && s; s = _sm_parent_of(s)) {
+        rez = first_goto(sm, s->gotos);
+        }
+    if (rez) { 
+        sm.phase = SM_Finish;
+        (*action)(sm); // count on the wrappers to inhibit as necessary
+        sm.phase = SM_Start;
+        return rez; 
+        }
     if ( again ) {
         // debugm("<again>" );
+        sm.phase = SM_Running; // (run() does too)
+        if (sm.waiting) {
+            // Can't park if there are GOTOWHEN's to check (ours or a superstate's), they have to run each pass
+            boolean gotos = preds[0].p != NULL;
+            for (const SuperState *s = parent ? (*parent)() : NULL; !gotos && s; s = _sm_parent_of(s)) gotos = s->gotos[0].p != NULL;
+            if (gotos) sm.unpark();
+            }
         return fromxtion;
         }
     else {
@@ -210,6 +639,17 @@ StateXtionFnPtr_ one_step(StateMachine &sm, ActionFnPtr action, StateXtionFnPtr
         }
     }
 
+#endif
+
+#define SUPERSTATE(name, first_state) _SUPERSTATE(NULL, name, NULL, first_state)
+#define SUPERSTATEAS(name, action, first_state) _SUPERSTATE(NULL, name, action_function_wrapper<action>, first_state)
+#define SUPERSTATEIN(parent, name, first_state) _SUPERSTATE(_##parent##_super, name, NULL, first_state)
+#define SUPERSTATEASIN(parent, name, action, first_state) _SUPERSTATE(_##parent##_super, name, action_function_wrapper<action>, first_state)
+#define STATEIN(parent, action, next_state) _STATEIN(_##parent##_super, action, action, next_state)
+#define STATEASIN(parent, name, action, next_state) _STATEIN(_##parent##_super, name, action, next_state)
+#define SIMPLESTATEIN(parent, action, next_state) STATEIN(parent, action, next_state) END_STATE
+#define SIMPLESTATEASIN(parent, name, action, next_state) STATEASIN(parent, name, action, next_state) END_STATE
+
 template<const int ms> boolean sm_delay(StateMachine &sm) {
     // we "stay" in this state till expired, so we can use the user_data
     if (sm.phase == SM_Finish) {
@@ -228,9 +668,194 @@ template<const int ms> boolean sm_delay(StateMachine &sm) {
         return false;
         }
 
+    // StateMachineScheduler won't run us till then (unless the state, or a superstate, has GOTOWHEN's to check)
+    sm.park_until(sm.user_ulong);
     return true; // again
     }
 
+// Wait for an SMEvent to be set (it's set back to false). e.g.
+//    SMEvent button_down;
+//    void on_button() { button_down = true; } // maybe from attachInterrupt()
+//    STATEAS(wait_button, ( sm_wait_event<button_down> ), do_something) END_STATE
+// With StateMachineScheduler, the machine isn't run at all till then.
+//   Unless the state (or any superstate) has GOTOWHEN's. We can't tell when a predicate might change,
+//   so they are checked every pass, and the machine isn't parked at all (same for sm_delay, sm_wait_pin).
+//   So a wait plus a guard (e.g. an E-stop GOTOWHEN on a superstate) saves nothing over polling.
+//   To keep the parking, take the guard out of the waiting machine: e.g. a small machine that polls estop()
+//   and does RESTART(the_waiter, safe), or set an SMEvent where the condition happens, and wait for that.
+template<SMEvent &event> boolean sm_wait_event(StateMachine &sm) {
+    if (sm.phase == SM_Finish) return false;
+    if (event) {
+      event = false; // we took it
+      return false;
+      }
+    sm.park_for_event(&event);
+    return true; // again
+    }
+
+// same, but give up after ms (check your SMEvent to see which)
+template<SMEvent &event, const int ms> boolean sm_wait_event_or(StateMachine &sm) {
+    if (sm.phase == SM_Finish) return false;
+    if (sm.phase == SM_Start) sm.user_ulong = millis() + ms;
+    if (event) {
+      event = false;
+      return false;
+      }
+    if ( (long)(millis() - sm.user_ulong) >= 0 ) return false;
+    sm.park_for_event(&event);
+    sm.park_until_or(sm.user_ulong);
+    return true;
+    }
+
+// Wait till digitalRead(pin) == level. Parked like sm_wait_event (a digitalRead() per pass), same GOTOWHEN caveat
+template<int pin, int level> boolean sm_wait_pin(StateMachine &sm) {
+    if (sm.phase == SM_Finish) return false;
+    if (digitalRead(pin) == level) return false;
+    sm.park_for_pin(pin, level);
+    return true;
+    }
+
+#ifndef SM_MAX_MACHINES
+#define SM_MAX_MACHINES 8
+#endif
+
+struct StateMachineStats {
+    StateMachine *machine;
+    byte priority; // higher runs first in StateMachineScheduler::Priority mode
+    unsigned long runs; // .run()'s
+    unsigned long parked; // passes we didn't run it because it was parked (e.g. sm_delay)
+    unsigned long transitions; // state changes
+    unsigned long run_us; // total micros() in its .run()
+    };
+
+class StateMachineScheduler {
+    // Runs several StateMachines, and keeps stats on each, so you can see who is eating the loop() time.
+    // Skips machines that are parked till what they wait for happens: sm_delay, sm_wait_event, sm_wait_pin.
+    // A parked machine costs a couple of compares per pass (a digitalRead() for sm_wait_pin).
+    // A state with GOTOWHEN's, its own or a superstate's, doesn't park: they have to be checked every pass.
+    //
+    //    STATEMACHINE(machine_a, ...)
+    //    STATEMACHINE(machine_b, ...)
+    //    void setup() {
+    //      StateMachineScheduler::add(machine_a);
+    //      StateMachineScheduler::add(machine_b, 10); // priority, higher first
+    //      }
+    //    void loop() {
+    //      StateMachineScheduler::run(); // each machine once
+    //      // or StateMachineScheduler::run(2000); // till 2000 micros have gone by, the next pass continues where we stopped
+    //      }
+    //    StateMachineScheduler::stats(machine_a)->run_us etc. StateMachineScheduler::print_stats()
+    //
+    // Mode RoundRobin (the default): a budget-limited pass starts where the last one stopped.
+    // Mode Priority: every pass starts at the highest priority.
+
+    public:
+    enum Mode { RoundRobin, Priority };
+
+    struct State {
+      StateMachineStats machines[SM_MAX_MACHINES]; // sorted by priority
+      byte count;
+      byte next; // for RoundRobin
+      Mode mode;
+      };
+    static State &state() { static State s; return s; }
+
+    static void mode(Mode m) { state().mode = m; }
+
+    static boolean add(StateMachine &sm, byte priority = 0) {
+      State &s = state();
+      if (s.count >= SM_MAX_MACHINES || stats(sm)) return false;
+      byte i = s.count++;
+      // keep sorted: higher priority first, first come first
+      for (; i > 0 && s.machines[i-1].priority < priority; i--) s.machines[i] = s.machines[i-1];
+      s.machines[i] = StateMachineStats{ &sm, priority, 0, 0, 0, 0 };
+      return true;
+      }
+
+    static void remove(StateMachine &sm) {
+      State &s = state();
+      for (byte i = 0; i < s.count; i++) {
+        if (s.machines[i].machine == &sm) {
+          for (s.count--; i < s.count; i++) s.machines[i] = s.machines[i+1];
+          s.next = 0;
+          return;
+          }
+        }
+      }
+
+    static StateMachineStats *stats(StateMachine &sm) {
+      State &s = state();
+      for (byte i = 0; i < s.count; i++) {
+        if (s.machines[i].machine == &sm) return &s.machines[i];
+        }
+      return NULL;
+      }
+
+    static void reset_stats() {
+      State &s = state();
+      for (byte i = 0; i < s.count; i++) {
+        StateMachineStats &st = s.machines[i];
+        st.runs = st.parked = st.transitions = st.run_us = 0;
+        }
+      }
+
+    // Runs each (unparked) machine once, or till budget_us micros have gone by (at least 1 runs).
+    // Returns how many ran.
+    static byte run(unsigned long budget_us = 0) {
+      State &s = state();
+      if (s.count == 0) return 0;
+
+      unsigned long now = millis();
+      unsigned long start_us = micros();
+      byte first = s.mode == RoundRobin && s.next < s.count ? s.next : 0;
+      byte ran = 0;
+
+      for (byte i = 0; i < s.count; i++) {
+        byte idx = first + i;
+        if (idx >= s.count) idx -= s.count;
+        StateMachineStats &st = s.machines[idx];
+        StateMachine &sm = *st.machine;
+
+        if (sm.current == NULL) continue; // finished
+        if (sm.is_parked(now)) {
+          st.parked++;
+          continue;
+          }
+
+        unsigned long before_us = micros();
+        auto was = sm.current;
+        sm.run();
+        unsigned long after_us = micros();
+
+        st.run_us += after_us - before_us;
+        st.runs++;
+        if (sm.current != was && sm.phase == SM_Start) st.transitions++; // (not a superstate handing over to its state)
+        ran++;
+
+        if (budget_us && after_us - start_us >= budget_us) {
+          s.next = idx + 1;
+          return ran;
+          }
+        }
+      s.next = first;
+      return ran;
+      }
+
+    static void print_stats() {
+      // tab separated: priority runs parked transitions run_us
+      State &s = state();
+      for (byte i = 0; i < s.count; i++) {
+        StateMachineStats &st = s.machines[i];
+        Serial.print((long) st.machine); Serial.print(F("\t"));
+        Serial.print(st.priority); Serial.print(F("\t"));
+        Serial.print(st.runs); Serial.print(F("\t"));
+        Serial.print(st.parked); Serial.print(F("\t"));
+        Serial.print(st.transitions); Serial.print(F("\t"));
+        Serial.println(st.run_us);
+        }
+      }
+    };
+
 // have to declare for ourselves to make this work
 // void digitalWrite(int, int);
 // template<void (&fn)(int, int), int a, int b> boolean sm_as_action(StateMachine &sm) { fn(a,b); return false; }